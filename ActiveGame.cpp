@@ -1,88 +1,212 @@
+#include <stdexcept>
 #include "ActiveGame.h"
 
 using namespace std;
 using namespace deflection;
 
+/**
+ * Returns a DrawCommand for the given ImageObject.
+ * @param object is the ImageObject to draw.
+ * @return the DrawCommand, with no movement since the last update.
+ */
+static DrawCommand makeDrawCommand(const ImageObject& object) noexcept {
+    DrawCommand command;
+    command.imageIndex = object.getImageIndex();
+    command.x = command.prevX = object.getCenterX();
+    command.y = command.prevY = object.getCenterY();
+    const Quad& corners = object.getVertices();
+    for (unsigned int c = 0; c < 4; c += 1) {
+        command.cornerX[c] = corners[c].x - object.getCenterX();
+        command.cornerY[c] = corners[c].y - object.getCenterY();
+    }
+    return command;
+}
+
+ActiveGame::ActiveGame(unsigned int screenWidth, unsigned int screenHeight,
+        unsigned int playerImageIndex, unsigned int targetImageIndex,
+        unsigned int wallImageIndex, unsigned int projectileImageIndex, unsigned int numWalls)
+: ActiveGame(screenWidth, screenHeight, playerImageIndex, targetImageIndex,
+        wallImageIndex, projectileImageIndex, numWalls, random_device()()) {
+}
+
 ActiveGame::ActiveGame(unsigned int screenWidth, unsigned int screenHeight,
         unsigned int playerImageIndex, unsigned int targetImageIndex,
-        unsigned int wallImageIndex, unsigned int projectileImageIndex, unsigned int numWalls) noexcept
-: screenWidth_(screenWidth), screenHeight_(screenHeight), r_(rd_()),
-distrX_(0, screenWidth), distrY_(0, screenHeight), distrA_(0, 180),
-walls_(), projectiles_(), numWalls_(numWalls), wallImageIndex_(wallImageIndex),
+        unsigned int wallImageIndex, unsigned int projectileImageIndex, unsigned int numWalls,
+        unsigned int seed, unsigned int maxProjectiles)
+: screenWidth_(screenWidth), screenHeight_(screenHeight), r_(seed),
+generator_(screenWidth, screenHeight, playerImageIndex, targetImageIndex, wallImageIndex),
+walls_(), projectiles_(projectileImageIndex, Player::PROJECTILE_SIDE_LENGTH, maxProjectiles), numWalls_(numWalls), wallImageIndex_(wallImageIndex),
 playerImageIndex_(playerImageIndex), targetImageIndex_(targetImageIndex),
-projectileImageIndex_(projectileImageIndex), player_(Player(0, 0, 0, 0)), target_(0, 0, 0, 0, 0, 0) {
+projectileImageIndex_(projectileImageIndex), player_(Player(0, 0, 0, 0)), target_(0, 0, 0, 0, 0, 0),
+projectileDraw_(makeDrawCommand(ImageObject(projectileImageIndex, 0.0, 0.0,
+        Player::PROJECTILE_SIDE_LENGTH, Player::PROJECTILE_SIDE_LENGTH, 0.0))) {
     startNewGame();
 }
 
-vector<ImageObject> ActiveGame::getImagesToDraw() const noexcept {
-    // Create a temporary vector to store the ImageObjects
-    vector<ImageObject> temp;
-    // Add the player
-    temp.push_back(player_);
-    // Add the target
-    temp.push_back(target_);
-    // Add the walls
-    for (ImageObject w : walls_) {
-        temp.push_back(w);
+const vector<DrawCommand>& ActiveGame::getDrawList() noexcept {
+    // Only the projectiles move, so the commands of the level are kept and
+    // the projectiles are written over the commands after them
+    drawList_.resize(numStaticDraws_ + projectiles_.size(), projectileDraw_);
+    for (unsigned int i = 0; i < projectiles_.size(); i += 1) {
+        DrawCommand& command = drawList_[numStaticDraws_ + i];
+        command.x = projectiles_.getCenterX(i);
+        command.y = projectiles_.getCenterY(i);
+        command.prevX = projectiles_.getPrevCenterX(i);
+        command.prevY = projectiles_.getPrevCenterY(i);
     }
-    // Add the projectiles
-    for (Projectile p : projectiles_) {
-        temp.push_back(p);
+    return drawList_;
+}
+
+void ActiveGame::writeStaticDraws() noexcept {
+    drawList_.clear();
+    drawList_.push_back(makeDrawCommand(player_));
+    drawList_.push_back(makeDrawCommand(target_));
+    for (const ImageObject& w : walls_) {
+        drawList_.push_back(makeDrawCommand(w));
     }
-    return temp;
-}
-
-void ActiveGame::updateState() noexcept {
-    // Iterate through the projectiles, moving them and checking if the
-    // number of collisions is too great, and if so removes them
-    for (auto i = projectiles_.begin(); i != projectiles_.end();) {
-        (*i).move(5, walls_, screenWidth_, screenHeight_);
-        if ((*i).getNumCollisions() > numWalls_) {
-            projectiles_.erase(i);
-        } else {
-            i += 1;
-        }
+    numStaticDraws_ = drawList_.size();
+}
+
+void ActiveGame::updateState(double seconds) noexcept {
+    // Move all the projectiles, noting the first to reach the target, and
+    // then remove the ones whose number of collisions is too great
+    int hit = projectiles_.move(PROJECTILE_SPEED * seconds, walls_, grid_,
+            screenWidth_, screenHeight_, target_, numWalls_, pool_.get());
+    won_ = hit >= 0;
+    if (won_) {
+        hitEvents_.push_back({projectiles_.getHandle(hit), tick_, projectiles_.getNumCollisions(hit)});
     }
+    tick_ += 1;
+    projectiles_.removeExpired(numWalls_);
 }
 
-void ActiveGame::playerFire(int x, int y) noexcept {
-    // Adds the projectile that the player fires to the vector of projectiles
-    projectiles_.push_back(player_.fire(x, y, projectileImageIndex_));
+ProjectileHandle ActiveGame::playerFire(int x, int y) noexcept {
+    // Adds the projectile that the player fires to the projectiles
+    return projectiles_.add(player_.fire(x, y, projectileImageIndex_));
 }
 
 bool ActiveGame::checkGameWon() const noexcept {
-    bool temp = false;
-    for (Projectile p : projectiles_) {
-        // Check if any projectiles are hitting the target
-        temp = p.hits(target_);
+    return won_;
+}
+
+const vector<HitEvent>& ActiveGame::getHitEvents() const noexcept {
+    return hitEvents_;
+}
+
+unsigned long long ActiveGame::getTick() const noexcept {
+    return tick_;
+}
+
+void ActiveGame::startNewGame() {
+    generateLevel();
+    keepWinnableLevel();
+}
+
+void ActiveGame::keepWinnableLevel() {
+    // Keep the level if it is winnable or if winnable levels are not
+    // required, and give up looking after too many attempts or if the
+    // solver fails
+    for (unsigned int attempt = 1; requireWinnable_ && attempt < MAX_LEVEL_ATTEMPTS; attempt += 1) {
+        try {
+            if (solveLevel().winnable) {
+                break;
+            }
+        } catch (const exception&) {
+            break;
+        }
+        generateLevel();
     }
-    return temp;
+    writeStaticDraws();
+}
+
+void ActiveGame::generateLevel() {
+    // Clear the projectiles and generate the player, target and walls
+    won_ = false;
+    hitEvents_.clear();
+    projectiles_.clear();
+    generation_ = generator_.generate(r_, numWalls_, player_, target_, walls_);
+
+    // The walls are fixed for the rest of the level, so the grid is only
+    // built once here
+    grid_.build(walls_, screenWidth_, screenHeight_);
 }
 
-void ActiveGame::startNewGame() noexcept {
-    // Randomly generate a player and a target
-    player_ = Player(playerImageIndex_, distrX_(r_), distrY_(r_), 30);
-    target_ = ImageObject(targetImageIndex_, distrX_(r_), distrY_(r_), 20, 20, 0);
-    // Clear the vectors of projectiles and walls
+void ActiveGame::startLevel(const LevelCorpus& corpus, unsigned int index) {
+    const CorpusHeader& header = corpus.getHeader();
+    if (header.screenWidth != screenWidth_ || header.screenHeight != screenHeight_) {
+        throw domain_error("The level corpus is for a " + to_string(header.screenWidth) + "x"
+                + to_string(header.screenHeight) + " screen, not " + to_string(screenWidth_)
+                + "x" + to_string(screenHeight_));
+    }
+    if (index >= corpus.size() || !corpus.isValid(corpus.getLevel(index))) {
+        throw domain_error("The level corpus has no valid level " + to_string(index));
+    }
+    const CorpusLevel& level = corpus.getLevel(index);
+    const CorpusWall* walls = corpus.getWalls(level);
+
+    // Build the level from its record, the same way generate would have
+    won_ = false;
+    hitEvents_.clear();
     projectiles_.clear();
+    player_ = Player(playerImageIndex_, level.playerX, level.playerY, level.playerSize);
+    target_ = ImageObject(targetImageIndex_, level.targetX, level.targetY,
+            level.targetWidth, level.targetLength, 0);
     walls_.clear();
-    // Randomly generate walls, only adding them if they
-    // don't collide with the player or the target
-    for (unsigned int i = 0; i < numWalls_; i += 1) {
-        for (;;) {
-            ImageObject w(wallImageIndex_, distrX_(r_), distrY_(r_), 10, distrX_(r_), distrA_(r_));
-            if (!w.hits(target_) && !w.hits(player_)) {
-                bool check = true;
-                for (const ImageObject& wall : walls_) {
-                    if (w.hits(wall)) {
-                        check = false;
-                    }
-                }
-                if (check) {
-                    walls_.push_back(w);
-                    break;
-                }
-            }
-        }
+    walls_.reserve(level.numWalls);
+    for (unsigned int i = 0; i < level.numWalls; i += 1) {
+        walls_.push_back(ImageObject(wallImageIndex_, walls[i].x, walls[i].y,
+                walls[i].width, walls[i].length, walls[i].angle));
     }
+    generation_ = {true, level.numWalls, 0};
+    grid_.build(walls_, screenWidth_, screenHeight_);
+    writeStaticDraws();
+}
+
+const Player& ActiveGame::getPlayer() const noexcept {
+    return player_;
+}
+
+const ImageObject& ActiveGame::getTarget() const noexcept {
+    return target_;
+}
+
+const vector<ImageObject>& ActiveGame::getWalls() const noexcept {
+    return walls_;
+}
+
+GenerationResult ActiveGame::getGenerationResult() const noexcept {
+    return generation_;
+}
+
+void ActiveGame::setRequireWinnable(bool requireWinnable) noexcept {
+    requireWinnable_ = requireWinnable;
+}
+
+SolveResult ActiveGame::solveLevel(bool stopAtFirstWin) const {
+    return solver_.solve(player_, target_, walls_, grid_, numWalls_,
+            screenWidth_, screenHeight_, stopAtFirstWin);
+}
+
+unsigned int ActiveGame::getNumProjectiles() const noexcept {
+    return projectiles_.size();
+}
+
+void ActiveGame::setNumThreads(unsigned int numThreads) {
+    pool_.reset();
+    if (numThreads != 1) {
+        pool_.reset(new ThreadPool(numThreads));
+        pool_->start();
+    }
+}
+
+void ActiveGame::setSolverThreads(unsigned int numThreads) noexcept {
+    solver_.setNumThreads(numThreads);
+}
+
+void ActiveGame::setTickSeconds(double seconds) noexcept {
+    solver_.setStep(PROJECTILE_SPEED * seconds);
+}
+
+const ProjectileStore& ActiveGame::getProjectiles() const noexcept {
+    return projectiles_;
 }
@@ -1,9 +1,15 @@
 #ifndef ACTIVEGAME_H
 #define ACTIVEGAME_H
 
+#include <memory>
 #include <random>
+#include "DrawCommand.h"
+#include "LevelCorpus.h"
+#include "LevelGenerator.h"
+#include "LevelSolver.h"
 #include "Player.h"
 #include "Projectile.h"
+#include "ProjectileStore.h"
 
 namespace deflection {
 
@@ -17,6 +23,15 @@ namespace deflection {
 class ActiveGame {
 public:
 
+    /** The speed of projectiles, in pixels per second. */
+    static constexpr double PROJECTILE_SPEED = 300.0;
+
+    /**
+     * The most levels generated by startNewGame while looking for a winnable
+     * one. If none of them is winnable, the last one is kept.
+     */
+    static constexpr unsigned int MAX_LEVEL_ATTEMPTS = 100;
+
     /**
      * Constructs a new active game, using the given parameters.
      * @param screenWidth is an unsigned int representing the width of the screen
@@ -36,41 +51,196 @@ public:
     ActiveGame(unsigned int screenWidth, unsigned int screenHeight,
             unsigned int playerImageIndex, unsigned int targetImageIndex,
             unsigned int wallImageIndex, unsigned int projectileImageIndex,
-            unsigned int numWalls) noexcept;
+            unsigned int numWalls);
+
+    /**
+     * Constructs a new active game, using the given parameters and seeding the
+     * random number generator with the given seed, so that the sequence of
+     * generated levels is reproducible.
+     * @param screenWidth is an unsigned int representing the width of the screen
+     * in pixels.
+     * @param screenHeight is an unsigned int representing the height of the screen
+     * in pixels.
+     * @param playerImageIndex is an unsigned int representing the index of the
+     * image for the player loaded in SDL.
+     * @param targetImageIndex is an unsigned int representing the index of the
+     * image for the target loaded in SDL.
+     * @param wallImageIndex is an unsigned int representing the index of the
+     * image for the wall loaded in SDL.
+     * @param projectileImageIndex is an unsigned int representing the index of the
+     * image for the projectile loaded in SDL.
+     * @param numWalls is the number of walls that should be generated in the game
+     * @param seed is the seed for the random number generator.
+     * @param maxProjectiles is the most projectiles the game holds at once.
+     * Games that are run by the thousand, such as the rooms of a server, use
+     * a small capacity, since the store of projectiles is allocated up front.
+     */
+    ActiveGame(unsigned int screenWidth, unsigned int screenHeight,
+            unsigned int playerImageIndex, unsigned int targetImageIndex,
+            unsigned int wallImageIndex, unsigned int projectileImageIndex,
+            unsigned int numWalls, unsigned int seed,
+            unsigned int maxProjectiles = ProjectileStore::DEFAULT_CAPACITY);
 
     /**
-     * Returns a vector ImageObjects which are all the drawable objects in this
-     * game.
-     * @return a vector of ImageObjects. 
+     * Returns the DrawCommands of all the drawable objects in this game: the
+     * player, the target, the walls, and then the projectiles. The commands of
+     * the level are written once when it starts, and only the commands of the
+     * projectiles are updated here, in place, so the list is not rebuilt or
+     * reallocated each frame.
+     * @return a const reference to the vector of DrawCommands, valid until the
+     * game is next changed.
      */
-    std::vector<ImageObject> getImagesToDraw() const noexcept;
+    const std::vector<DrawCommand>& getDrawList() noexcept;
 
     /**
      * Updates the state of the game, moving any projectiles the correct amount
      * and removing projectiles that have hit too many walls.
+     * @param seconds is the length of the update in seconds. Updates are
+     * meant to be of a fixed length, and the default of one sixtieth of a
+     * second moves projectiles 5 pixels.
      */
-    void updateState() noexcept;
+    void updateState(double seconds = 1.0 / 60.0) noexcept;
 
     /**
      * Has the player of this active game fire towards the given coordinates.
      * @param x is the x coordinate to fire towards.
      * @param y is the y coordinate to fire towards.
+     * @return the handle of the projectile fired, or
+     * ProjectileStore::INVALID_HANDLE if there are too many projectiles.
      */
-    void playerFire(int x, int y) noexcept;
+    ProjectileHandle playerFire(int x, int y) noexcept;
 
     /**
-     * Determines whether any projectile is in contact with the target, which
-     * indicates that the game has been won.
+     * Determines whether a projectile reached the target in the last update,
+     * which indicates that the game has been won. The target is checked while
+     * the projectiles are moved by updateState, so this does no work.
      * @return true if the game has been won, false otherwise.
      */
     bool checkGameWon() const noexcept;
 
+    /**
+     * Returns the projectiles that have reached the target in the current
+     * level, at most one per update, in the order they did.
+     * @return a const reference to the vector of HitEvents.
+     */
+    const std::vector<HitEvent>& getHitEvents() const noexcept;
+
+    /**
+     * Returns the number of updates since this game was constructed.
+     * @return the number of ticks.
+     */
+    unsigned long long getTick() const noexcept;
+
     /**
      * Starts a new game with a randomly placed player, randomly placed target,
      * and randomly placed and sized walls. All objects are guaranteed to not
-     * overlap.
+     * overlap. If the screen is too crowded to place every wall, the level has
+     * fewer walls, as reported by getGenerationResult. If winnable levels are
+     * required, levels are generated until the LevelSolver finds a winning
+     * shot, up to MAX_LEVEL_ATTEMPTS times. If the solver cannot run, such as
+     * when its threads cannot be started, the last level generated is kept.
+     */
+    void startNewGame();
+
+    /**
+     * Keeps the current level if winnable levels are not required or the
+     * LevelSolver finds a winning shot, and otherwise generates levels as
+     * startNewGame does, counting the current level as the first attempt. A
+     * game that requires winnable levels once its solver is set up calls this
+     * instead of startNewGame, so that its first level is not thrown away.
+     */
+    void keepWinnableLevel();
+
+    /**
+     * Starts a new game with the player, target and walls of a level of the
+     * given corpus, instead of generating them.
+     * @param corpus is the LevelCorpus to take the level from.
+     * @param index is the index of the level in the corpus.
+     * @throw domain_error if the corpus is for another size of screen, or if
+     * there is no such level or its walls are not in the corpus.
+     */
+    void startLevel(const LevelCorpus& corpus, unsigned int index);
+
+    /**
+     * Returns the player of the current level.
+     * @return a const reference to the Player.
+     */
+    const Player& getPlayer() const noexcept;
+
+    /**
+     * Returns the target of the current level.
+     * @return a const reference to the target.
+     */
+    const ImageObject& getTarget() const noexcept;
+
+    /**
+     * Returns the walls of the current level.
+     * @return a const reference to the vector of walls.
      */
-    void startNewGame() noexcept;
+    const std::vector<ImageObject>& getWalls() const noexcept;
+
+    /**
+     * Returns the result of generating the current level.
+     * @return the GenerationResult of the current level.
+     */
+    GenerationResult getGenerationResult() const noexcept;
+
+    /**
+     * Sets whether startNewGame and keepWinnableLevel should only accept
+     * levels that the LevelSolver can win.
+     * @param requireWinnable is whether levels must be winnable.
+     */
+    void setRequireWinnable(bool requireWinnable) noexcept;
+
+    /**
+     * Solves the current level, finding the directions the player can fire
+     * in to win it.
+     * @param stopAtFirstWin is whether to stop as soon as any winning shot is
+     * found.
+     * @return the SolveResult.
+     */
+    SolveResult solveLevel(bool stopAtFirstWin = true) const;
+
+    /**
+     * Sets the number of threads projectiles are moved with, when there are
+     * enough of them to be worth splitting. Projectiles are moved on the
+     * calling thread until this is called. The threads are started here, so
+     * that updateState never starts them.
+     * @param numThreads is the number of threads, 0 for one per hardware
+     * thread, or 1 to always move projectiles on the calling thread.
+     * @throw system_error if the threads cannot be started.
+     */
+    void setNumThreads(unsigned int numThreads);
+
+    /**
+     * Sets the number of threads the LevelSolver uses to check that levels
+     * are winnable. Games that are run many at once across threads, such as
+     * the rooms of a server, solve on the thread that starts the level.
+     * @param numThreads is the number of threads, 0 for one per hardware
+     * thread, or 1 to solve on the calling thread.
+     */
+    void setSolverThreads(unsigned int numThreads) noexcept;
+
+    /**
+     * Sets the length of the ticks the game is updated with, so that the
+     * LevelSolver moves its shots as far each tick as updateState does.
+     * @param seconds is the length of a tick in seconds, by default one
+     * sixtieth of a second.
+     */
+    void setTickSeconds(double seconds) noexcept;
+
+    /**
+     * Returns the number of projectiles currently in this game.
+     * @return an unsigned int representing the number of projectiles.
+     */
+    unsigned int getNumProjectiles() const noexcept;
+
+    /**
+     * Returns the projectiles of this game, which can be looked up by the
+     * handles returned by playerFire.
+     * @return a const reference to the ProjectileStore.
+     */
+    const ProjectileStore& getProjectiles() const noexcept;
 
 private:
 
@@ -95,21 +265,20 @@ private:
     /** An unsigned int representing the index of the projectile image loaded in SDL. */
     const unsigned int projectileImageIndex_;
 
-    /** The random device used to seed the random number generator. */
-    std::random_device rd_;
-
     /** The random number generator used to randomly generate levels. */
     std::mt19937 r_;
 
-    /** The distribution for random generation of any x values. */
-    std::uniform_int_distribution<int> distrX_;
+    /** The generator of the levels. */
+    LevelGenerator generator_;
 
-    /** The distribution for random generation of any y values. */
-    std::uniform_int_distribution<int> distrY_;
+    /** The result of generating the current level. */
+    GenerationResult generation_;
 
-    /** The distribution for random generation of angles. */
-    std::uniform_int_distribution<int> distrA_;
+    /** Whether startNewGame and keepWinnableLevel only accept winnable levels. */
+    bool requireWinnable_ = false;
 
+    /** The solver used to check that levels are winnable. */
+    LevelSolver solver_;
 
     /** The Player of this ActiveGame. */
     Player player_;
@@ -120,8 +289,50 @@ private:
     /** The vector of ImageObjects representing walls in this ActiveGame. */
     std::vector<ImageObject> walls_;
 
-    /** The vector of Projectiles in this ActiveGame. */
-    std::vector<Projectile> projectiles_;
+    /** The grid of the walls in this ActiveGame, rebuilt for each level. */
+    WallGrid grid_;
+
+    /** The Projectiles in this ActiveGame. */
+    ProjectileStore projectiles_;
+
+    /**
+     * The threads the projectiles are moved with, started by setNumThreads,
+     * or nullptr to move them on the calling thread.
+     */
+    std::unique_ptr<ThreadPool> pool_;
+
+    /** The number of updates since this ActiveGame was constructed. */
+    unsigned long long tick_ = 0;
+
+    /** Whether a projectile reached the target in the last update. */
+    bool won_ = false;
+
+    /** The projectiles that have reached the target in the current level. */
+    std::vector<HitEvent> hitEvents_;
+
+    /**
+     * The DrawCommands of this ActiveGame, starting with the numStaticDraws_
+     * commands of the level.
+     */
+    std::vector<DrawCommand> drawList_;
+
+    /** The number of DrawCommands of the level, which do not move. */
+    unsigned int numStaticDraws_ = 0;
+
+    /** The DrawCommand of a projectile, whose center is updated for each. */
+    DrawCommand projectileDraw_;
+
+    /**
+     * Clears the projectiles and generates a new player, target and walls,
+     * building the grid of the walls.
+     */
+    void generateLevel();
+
+    /**
+     * Writes the DrawCommands of the player, target and walls of the level
+     * that has just started.
+     */
+    void writeStaticDraws() noexcept;
 };
 }
 
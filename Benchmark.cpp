@@ -0,0 +1,607 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ActiveGame.h"
+#include "WallGrid.h"
+
+using namespace std;
+using namespace deflection;
+
+/**
+ * The options of a benchmark run.
+ */
+struct BenchmarkOptions {
+    /** The numbers of walls to benchmark with. */
+    vector<unsigned int> walls = {10, 100, 1000};
+
+    /** The numbers of projectiles to benchmark with. */
+    vector<unsigned int> projectiles = {10, 1000};
+
+    /** The distributions of wall angles to benchmark with. */
+    vector<string> angles = {"uniform", "axis"};
+
+    /** The number of timed samples of each benchmark. */
+    unsigned int samples = 15;
+
+    /** The shortest time a sample may take, in seconds. */
+    double minSampleSeconds = 0.01;
+
+    /** The seed for the random number generators. */
+    unsigned int seed = 1;
+
+    /** The number of threads games move projectiles with, 0 for one per hardware thread. */
+    unsigned int threads = 0;
+
+    /** Only benchmarks whose names contain this are run. */
+    string filter;
+
+    /** The location to write JSON results to, "-" for standard output, or empty. */
+    string json;
+};
+
+/**
+ * The statistics of the samples of a benchmark, in nanoseconds per operation.
+ */
+struct Statistics {
+    /** The fastest sample. */
+    double min;
+
+    /** The median sample. */
+    double median;
+
+    /** The mean of the samples. */
+    double mean;
+
+    /** The 90th percentile sample. */
+    double p90;
+
+    /** The standard deviation of the samples. */
+    double stddev;
+
+    /** The number of operations timed in each sample. */
+    unsigned long long iterations;
+};
+
+/**
+ * The result of one benchmark with one set of parameters.
+ */
+struct BenchmarkResult {
+    /** The name of the benchmark. */
+    string name;
+
+    /** The number of walls, or 0 if it does not apply. */
+    unsigned int walls;
+
+    /** The number of projectiles, or 0 if it does not apply. */
+    unsigned int projectiles;
+
+    /** The distribution of wall angles, or "generated" for generated levels. */
+    string angles;
+
+    /** The statistics of the samples. */
+    Statistics stats;
+};
+
+/**
+ * Results are added to this, so that the compiler cannot remove the work
+ * being timed.
+ */
+static volatile double sink = 0.0;
+
+/**
+ * Time spent by an operation on setup that should not be timed, in seconds,
+ * which is taken off the time of the sample it was spent in.
+ */
+static double untimedSeconds = 0.0;
+
+/**
+ * Prints the usage of the benchmark to the given stream.
+ * @param out is the stream to print to.
+ */
+static void printUsage(ostream& out) {
+    out << "Usage: benchmark [--walls N,N,...] [--projectiles N,N,...]"
+            << " [--angles uniform|axis|fixed,...] [--samples N] [--min-sample-ms N]"
+            << " [--seed N] [--threads N] [--filter NAME] [--json FILE|-]" << endl;
+}
+
+/**
+ * Splits a comma separated list.
+ * @param list is the list.
+ * @return a vector of the items of the list.
+ */
+static vector<string> split(const string& list) {
+    vector<string> items;
+    stringstream in(list);
+    string item;
+    while (getline(in, item, ',')) {
+        items.push_back(item);
+    }
+    return items;
+}
+
+/**
+ * Parses a comma separated list of numbers.
+ * @param list is the list.
+ * @return a vector of the numbers of the list.
+ */
+static vector<unsigned int> splitNumbers(const string& list) {
+    vector<unsigned int> numbers;
+    for (const string& item : split(list)) {
+        numbers.push_back(stoul(item));
+    }
+    return numbers;
+}
+
+/**
+ * Parses the command line arguments into benchmark options.
+ * @param argc is the number of arguments.
+ * @param argv is the array of arguments.
+ * @return the parsed options.
+ * @throw invalid_argument if an argument is unknown or is missing its value.
+ */
+static BenchmarkOptions parseOptions(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; i += 1) {
+        const string name = argv[i];
+        if (i + 1 == argc) {
+            throw invalid_argument("Missing value for " + name);
+        }
+        const string value = argv[i + 1];
+        i += 1;
+        if (name == "--walls") {
+            options.walls = splitNumbers(value);
+            for (unsigned int numWalls : options.walls) {
+                if (numWalls == 0) {
+                    throw invalid_argument("The numbers of walls must be positive");
+                }
+            }
+        } else if (name == "--projectiles") {
+            options.projectiles = splitNumbers(value);
+        } else if (name == "--angles") {
+            options.angles = split(value);
+            for (const string& angles : options.angles) {
+                if (angles != "uniform" && angles != "axis" && angles != "fixed") {
+                    throw invalid_argument("Unknown angle distribution " + angles);
+                }
+            }
+        } else if (name == "--samples") {
+            options.samples = max(1ul, stoul(value));
+        } else if (name == "--min-sample-ms") {
+            options.minSampleSeconds = stod(value) / 1000.0;
+        } else if (name == "--seed") {
+            options.seed = stoul(value);
+        } else if (name == "--threads") {
+            options.threads = stoul(value);
+        } else if (name == "--filter") {
+            options.filter = value;
+        } else if (name == "--json") {
+            options.json = value;
+        } else {
+            throw invalid_argument("Unknown option " + name);
+        }
+    }
+    return options;
+}
+
+/**
+ * Times the given operation. The number of operations per sample is doubled
+ * until a sample takes at least the minimum time, which also warms up the
+ * caches and branch predictors, and then the samples are timed. Any time the
+ * operation adds to untimedSeconds is not counted.
+ * @param run runs the operation the given number of times.
+ * @param options are the benchmark options.
+ * @return the Statistics of the samples.
+ */
+static Statistics measure(const function<void(unsigned long long)>& run,
+        const BenchmarkOptions& options) {
+    unsigned long long iterations = 1;
+    for (;;) {
+        untimedSeconds = 0.0;
+        auto start = chrono::steady_clock::now();
+        run(iterations);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count()
+                - untimedSeconds;
+        if (seconds >= options.minSampleSeconds || iterations >= (1ull << 40)) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    vector<double> samples;
+    for (unsigned int sample = 0; sample < options.samples; sample += 1) {
+        untimedSeconds = 0.0;
+        auto start = chrono::steady_clock::now();
+        run(iterations);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count()
+                - untimedSeconds;
+        samples.push_back(seconds * 1e9 / iterations);
+    }
+    sort(samples.begin(), samples.end());
+
+    Statistics stats;
+    stats.iterations = iterations;
+    stats.min = samples.front();
+    stats.median = samples[samples.size() / 2];
+    stats.p90 = samples[min(samples.size() - 1, samples.size() * 9 / 10)];
+    double sum = 0.0;
+    for (double s : samples) {
+        sum += s;
+    }
+    stats.mean = sum / samples.size();
+    double squares = 0.0;
+    for (double s : samples) {
+        squares += (s - stats.mean) * (s - stats.mean);
+    }
+    stats.stddev = sqrt(squares / samples.size());
+    return stats;
+}
+
+/**
+ * Returns the size of a screen for the given number of walls, growing with
+ * the number of walls so that their density stays that of 10 walls on a 640 by
+ * 480 screen.
+ * @param numWalls is the number of walls.
+ * @param width is set to the width of the screen.
+ * @param height is set to the height of the screen.
+ */
+static void screenFor(unsigned int numWalls, unsigned int& width, unsigned int& height) {
+    double scale = sqrt(max(1u, numWalls) / 10.0);
+    width = max(640.0, 640 * scale);
+    height = max(480.0, 480 * scale);
+}
+
+/**
+ * Makes walls spread over the screen with random lengths, whose angles follow
+ * the given distribution: uniform from 0 to 180 degrees as levels are
+ * generated, only 0 or 90 degrees, or all 45 degrees. Walls may overlap.
+ * @param numWalls is the number of walls.
+ * @param angles is the distribution of the angles.
+ * @param width is the width of the screen.
+ * @param height is the height of the screen.
+ * @param r is the random number generator.
+ * @return the vector of walls.
+ */
+static vector<ImageObject> makeWalls(unsigned int numWalls, const string& angles,
+        unsigned int width, unsigned int height, mt19937& r) {
+    uniform_int_distribution<int> distrX(0, width);
+    uniform_int_distribution<int> distrY(0, height);
+    uniform_int_distribution<int> distrL(20, 200);
+    uniform_int_distribution<int> distrA(0, 180);
+    vector<ImageObject> walls;
+    for (unsigned int i = 0; i < numWalls; i += 1) {
+        int x = distrX(r);
+        int y = distrY(r);
+        int length = distrL(r);
+        double angle = 45.0;
+        if (angles == "uniform") {
+            angle = distrA(r);
+        } else if (angles == "axis") {
+            angle = distrA(r) < 90 ? 0.0 : 90.0;
+        }
+        walls.push_back(ImageObject(2, x, y, 10, length, angle));
+    }
+    return walls;
+}
+
+/**
+ * Makes random points on the screen.
+ * @param count is the number of points.
+ * @param width is the width of the screen.
+ * @param height is the height of the screen.
+ * @param r is the random number generator.
+ * @return the vector of points.
+ */
+static vector<Vec2> makePoints(unsigned int count, unsigned int width, unsigned int height,
+        mt19937& r) {
+    uniform_real_distribution<double> distrX(0, width);
+    uniform_real_distribution<double> distrY(0, height);
+    vector<Vec2> points;
+    for (unsigned int i = 0; i < count; i += 1) {
+        points.push_back({distrX(r), distrY(r)});
+    }
+    return points;
+}
+
+/**
+ * Runs the benchmarks of the geometry of ImageObjects and of Projectile::move,
+ * which depend on the number and angles of the walls.
+ * @param numWalls is the number of walls.
+ * @param angles is the distribution of the wall angles.
+ * @param options are the benchmark options.
+ * @param results are the results to add to.
+ */
+static void benchmarkGeometry(unsigned int numWalls, const string& angles,
+        const BenchmarkOptions& options, vector<BenchmarkResult>& results) {
+    mt19937 r(options.seed);
+    unsigned int width;
+    unsigned int height;
+    screenFor(numWalls, width, height);
+    vector<ImageObject> walls = makeWalls(numWalls, angles, width, height, r);
+    vector<Vec2> points = makePoints(4096, width, height, r);
+    const size_t mask = points.size() - 1;
+    auto add = [&](const string& name, const function<void(unsigned long long)>& run) {
+        if (name.find(options.filter) != string::npos) {
+            results.push_back({name, numWalls, 0, angles, measure(run, options)});
+        }
+    };
+
+    // Moving an ImageObject and then getting its corners
+    add("ImageObject::getVertices", [&](unsigned long long iterations) {
+        double total = 0.0;
+        for (unsigned long long i = 0; i < iterations; i += 1) {
+            ImageObject& wall = walls[i % walls.size()];
+            const Vec2& p = points[i & mask];
+            wall.setCenter(p.x, p.y);
+            total += wall.getVertices()[2].x;
+        }
+        sink = sink + total;
+    });
+    walls = makeWalls(numWalls, angles, width, height, r);
+
+    // A projectile at a random point against one wall
+    ImageObject body(3, 0.0, 0.0, Player::PROJECTILE_SIDE_LENGTH, Player::PROJECTILE_SIDE_LENGTH, 0.0);
+    add("ImageObject::hits", [&](unsigned long long iterations) {
+        unsigned int total = 0;
+        for (unsigned long long i = 0; i < iterations; i += 1) {
+            const Vec2& p = points[i & mask];
+            body.setCenter(p.x, p.y);
+            total += body.hits(walls[i % walls.size()]);
+        }
+        sink = sink + total;
+    });
+
+    // The same with the kernel for an axis-aligned box against a rotated one
+    add("ImageObject::hits<AxisAligned, Oriented>", [&](unsigned long long iterations) {
+        unsigned int total = 0;
+        for (unsigned long long i = 0; i < iterations; i += 1) {
+            const Vec2& p = points[i & mask];
+            body.setCenter(p.x, p.y);
+            total += body.hits<AxisAligned, Oriented>(walls[i % walls.size()]);
+        }
+        sink = sink + total;
+    });
+
+    // A projectile at a random point against a target sized box at another
+    ImageObject target(1, 0.0, 0.0, 20, 20, 0.0);
+    add("ImageObject::hits<AxisAligned, AxisAligned>", [&](unsigned long long iterations) {
+        unsigned int total = 0;
+        for (unsigned long long i = 0; i < iterations; i += 1) {
+            const Vec2& p = points[i & mask];
+            const Vec2& q = points[(i + 1) & mask];
+            body.setCenter(p.x, p.y);
+            target.setCenter(q.x, q.y);
+            total += body.hits<AxisAligned, AxisAligned>(target);
+        }
+        sink = sink + total;
+    });
+
+    // The same projectile finding its contact with a target overlapping it
+    add("ImageObject::contact<AxisAligned, AxisAligned>", [&](unsigned long long iterations) {
+        double total = 0.0;
+        for (unsigned long long i = 0; i < iterations; i += 1) {
+            const Vec2& p = points[i & mask];
+            body.setCenter(p.x, p.y);
+            target.setCenter(p.x + 5.0 + (i & 7), p.y - 3.0);
+            total += body.contact<AxisAligned, AxisAligned>(target).depth;
+        }
+        sink = sink + total;
+    });
+
+    // A projectile placed on the middle of a wall bouncing off of it
+    vector<Vec2> centers;
+    for (const ImageObject& wall : walls) {
+        centers.push_back({wall.getCenterX(), wall.getCenterY()});
+    }
+    add("ImageObject::bounce", [&](unsigned long long iterations) {
+        double total = 0.0;
+        for (unsigned long long i = 0; i < iterations; i += 1) {
+            size_t w = i % walls.size();
+            body.setCenter(centers[w].x + 3.0, centers[w].y);
+            Vec2 v = body.bounce(walls[w], 0.5, -0.5);
+            total += v.x;
+        }
+        sink = sink + total;
+    });
+
+    // The same projectile finding its contact with the wall instead, which
+    // is what bouncing off walls uses
+    add("ImageObject::contact<AxisAligned, Oriented>", [&](unsigned long long iterations) {
+        double total = 0.0;
+        for (unsigned long long i = 0; i < iterations; i += 1) {
+            size_t w = i % walls.size();
+            body.setCenter(centers[w].x + 3.0, centers[w].y);
+            total += body.contact<AxisAligned, Oriented>(walls[w]).depth;
+        }
+        sink = sink + total;
+    });
+
+    add("ImageObject::lineDistance", [&](unsigned long long iterations) {
+        double total = 0.0;
+        for (unsigned long long i = 0; i < iterations; i += 1) {
+            total += ImageObject::lineDistance(points[i & mask], points[(i + 1) & mask],
+                    points[(i + 2) & mask]);
+        }
+        sink = sink + total;
+    });
+
+    // One projectile moving through the walls for as long as it is timed
+    WallGrid grid;
+    grid.build(walls, width, height);
+    Projectile projectile(3, width / 2.0, height / 2.0, 0.3, 0.7, Player::PROJECTILE_SIDE_LENGTH);
+    add("Projectile::move", [&](unsigned long long iterations) {
+        for (unsigned long long i = 0; i < iterations; i += 1) {
+            projectile.move(5.0, walls, grid, width, height);
+        }
+        sink = sink + projectile.getCenterX();
+    });
+}
+
+/**
+ * Fires projectiles from the player of the game at random points until it has
+ * the given number of projectiles.
+ * @param game is the ActiveGame.
+ * @param numProjectiles is the number of projectiles.
+ * @param width is the width of the screen.
+ * @param height is the height of the screen.
+ * @param r is the random number generator.
+ */
+static void refill(ActiveGame& game, unsigned int numProjectiles, unsigned int width,
+        unsigned int height, mt19937& r) {
+    uniform_int_distribution<int> distrX(0, width);
+    uniform_int_distribution<int> distrY(0, height);
+    while (game.getNumProjectiles() < numProjectiles) {
+        game.playerFire(distrX(r), distrY(r));
+    }
+}
+
+/**
+ * Runs the benchmarks of ActiveGame, on generated levels.
+ * @param numWalls is the number of walls.
+ * @param numProjectiles is the number of projectiles.
+ * @param options are the benchmark options.
+ * @param results are the results to add to.
+ */
+static void benchmarkGame(unsigned int numWalls, unsigned int numProjectiles,
+        const BenchmarkOptions& options, vector<BenchmarkResult>& results) {
+    mt19937 r(options.seed);
+    unsigned int width;
+    unsigned int height;
+    screenFor(numWalls, width, height);
+    ActiveGame game(width, height, 0, 1, 2, 3, numWalls, options.seed);
+    game.setNumThreads(options.threads);
+    auto add = [&](const string& name, unsigned int projectiles,
+            const function<void(unsigned long long)>& run) {
+        if (name.find(options.filter) != string::npos) {
+            results.push_back({name, numWalls, projectiles, "generated", measure(run, options)});
+        }
+    };
+
+    // Projectiles expire as they bounce, so they are topped up between short
+    // runs of updates, outside of the timing
+    add("ActiveGame::updateState", numProjectiles, [&](unsigned long long iterations) {
+        for (unsigned long long i = 0; i < iterations; i += 16) {
+            auto start = chrono::steady_clock::now();
+            refill(game, numProjectiles, width, height, r);
+            untimedSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            for (unsigned long long j = i; j < iterations && j < i + 16; j += 1) {
+                game.updateState();
+            }
+        }
+        sink = sink + game.getNumProjectiles();
+    });
+
+    refill(game, numProjectiles, width, height, r);
+    add("ActiveGame::getDrawList", numProjectiles, [&](unsigned long long iterations) {
+        size_t total = 0;
+        for (unsigned long long i = 0; i < iterations; i += 1) {
+            total += game.getDrawList().size();
+        }
+        sink = sink + total;
+    });
+
+    // Generating a level does not depend on the projectiles
+    if (numProjectiles == options.projectiles.front()) {
+        add("ActiveGame::startNewGame", 0, [&](unsigned long long iterations) {
+            for (unsigned long long i = 0; i < iterations; i += 1) {
+                game.startNewGame();
+            }
+            sink = sink + game.getWalls().size();
+        });
+    }
+}
+
+/**
+ * Writes the results as JSON.
+ * @param out is the stream to write to.
+ * @param results are the results.
+ * @param options are the benchmark options.
+ */
+static void writeJson(ostream& out, const vector<BenchmarkResult>& results,
+        const BenchmarkOptions& options) {
+#if defined(__AVX2__)
+    const char* simd = "avx2";
+#elif defined(__SSE2__)
+    const char* simd = "sse2";
+#else
+    const char* simd = "scalar";
+#endif
+    out << "{\n  \"simd\": \"" << simd << "\",\n  \"seed\": " << options.seed
+            << ",\n  \"threads\": " << options.threads
+            << ",\n  \"samples\": " << options.samples << ",\n  \"unit\": \"ns/op\",\n"
+            << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i += 1) {
+        const BenchmarkResult& result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << result.name
+                << "\", \"walls\": " << result.walls
+                << ", \"projectiles\": " << result.projectiles
+                << ", \"angles\": \"" << result.angles
+                << "\", \"iterations\": " << result.stats.iterations
+                << ", \"min\": " << result.stats.min
+                << ", \"median\": " << result.stats.median
+                << ", \"mean\": " << result.stats.mean
+                << ", \"p90\": " << result.stats.p90
+                << ", \"stddev\": " << result.stats.stddev << "}";
+    }
+    out << "\n  ]\n}" << endl;
+}
+
+/**
+ * Microbenchmarks of the geometry and simulation hot paths of the deflection
+ * game. Each benchmark is run for every combination of the parameters it
+ * depends on, and is timed as a number of samples, each long enough to be
+ * stable, reporting the spread of the samples in nanoseconds per operation.
+ * Results are printed as a table, and written as JSON with --json, where
+ * --json - writes the JSON to stdout and the table to stderr instead. Like
+ * simulate, this only needs the game logic.
+ * @return The status code. Status code 0 means
+ * the program succeeds, and nonzero status code
+ * means the program failed.
+ */
+int main(int argc, char* argv[]) {
+    try {
+        BenchmarkOptions options = parseOptions(argc, argv);
+        vector<BenchmarkResult> results;
+        for (unsigned int numWalls : options.walls) {
+            for (const string& angles : options.angles) {
+                benchmarkGeometry(numWalls, angles, options, results);
+            }
+            for (unsigned int numProjectiles : options.projectiles) {
+                benchmarkGame(numWalls, numProjectiles, options, results);
+            }
+        }
+
+        // The table goes to stderr when the JSON goes to stdout, so that
+        // stdout can be parsed
+        ostream& table = options.json == "-" ? cerr : cout;
+        table << "Benchmark\tWalls\tProjectiles\tAngles\tMedian ns\tMin ns\tStddev ns" << endl;
+        for (const BenchmarkResult& result : results) {
+            table << result.name << "\t" << result.walls << "\t" << result.projectiles << "\t"
+                    << result.angles << "\t" << result.stats.median << "\t"
+                    << result.stats.min << "\t" << result.stats.stddev << endl;
+        }
+
+        if (options.json == "-") {
+            writeJson(cout, results, options);
+        } else if (!options.json.empty()) {
+            ofstream out(options.json);
+            if (!out) {
+                throw domain_error("Unable to write to " + options.json);
+            }
+            writeJson(out, results, options);
+        }
+        return 0;
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        printUsage(cerr);
+        return 1;
+    }
+}
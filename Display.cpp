@@ -1,13 +1,13 @@
 #include <SDL2/SDL.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 #include <iostream>
-#include <memory>
 
 #include "Display.h"
-#include "Request.h"
-#include "QuitRequest.h"
-#include "ButtonRequest.h"
-#include "RestartRequest.h"
+#include "Trace.h"
 
 using namespace std;
 using namespace deflection;
@@ -15,9 +15,12 @@ using namespace deflection;
 Display::Display(int width, int height)
 : width_(width), height_(height) {
 
-    // Initialize SDL2
+    // Initialize only the parts of SDL2 that are
+    // used, as audio, haptics and controllers are
+    // slow to start. Others can be started later
+    // with SDL_InitSubSystem if they are needed.
 
-    if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) != 0) {
         throw domain_error(string("SDL Initialization failed due to: ") + SDL_GetError());
     }
 
@@ -53,11 +56,15 @@ void Display::close() noexcept {
     // Delete the SDL2 resources in reverse order of
     // their construction, starting with the images
 
-    for (SDL_Texture* image : images_) {
-        if (image) {
-            SDL_DestroyTexture(image);
+    for (Image& image : images_) {
+        if (image.surface) {
+            SDL_FreeSurface(image.surface);
         }
     }
+    if (atlas_) {
+        SDL_DestroyTexture(atlas_);
+        atlas_ = nullptr;
+    }
 
     // Clear the collection of images to ensure
     // idempotence
@@ -83,50 +90,90 @@ void Display::close() noexcept {
 
 int Display::addImage(const string& fileLocation) noexcept {
     if (renderer_) {
+        return addSurface(SDL_LoadBMP(fileLocation.c_str()), fileLocation);
+    }
+    return -1;
+}
 
-        // Load the image from the file
-
-        SDL_Surface* imageSurface = SDL_LoadBMP(fileLocation.c_str());
-        if (imageSurface) {
+int Display::addImage(const unsigned char* data, size_t size, const string& name) noexcept {
+    if (renderer_) {
 
-            // Convert the image to a texture
+        // Read the image in place, closing the stream
+        // once it is read
 
-            SDL_Texture* imageTexture =
-                    SDL_CreateTextureFromSurface(renderer_, imageSurface);
-            if (imageTexture) {
+        SDL_RWops* stream = SDL_RWFromConstMem(data, size);
+        return addSurface(stream ? SDL_LoadBMP_RW(stream, 1) : nullptr, name);
+    }
+    return -1;
+}
 
-                // Add the image to the collection
+int Display::addSurface(SDL_Surface* loaded, const string& name) noexcept {
 
-                images_.push_back(imageTexture);
-            } else {
-                cerr << "Unable to load the image file at " << fileLocation
-                        << " due to: " << SDL_GetError() << endl;
-            }
+    // Convert the image to bytes of red, green,
+    // blue and alpha
 
-            // The surface is not longer needed
+    SDL_Surface* imageSurface = loaded
+            ? SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+    if (loaded) {
+        SDL_FreeSurface(loaded);
+    }
+    if (!imageSurface) {
+        cerr << "Unable to load the image " << name << " due to: " << SDL_GetError() << endl;
+        return -1;
+    }
 
-            SDL_FreeSurface(imageSurface);
-            return images_.size() - 1;
-        } else {
-            cerr << "Unable to load the image file at " << fileLocation
-                    << " due to: " << SDL_GetError() << endl;
+    // Check whether every pixel is close to the
+    // first, in which case the image is drawn as
+    // its average color
+
+    Image image = {};
+    image.solid = true;
+    const unsigned char* first = static_cast<const unsigned char*>(imageSurface->pixels);
+    unsigned long long sums[4] = {0, 0, 0, 0};
+    for (int y = 0; y < imageSurface->h && image.solid; y += 1) {
+        const unsigned char* row = first + y * imageSurface->pitch;
+        for (int x = 0; x < imageSurface->w * 4; x += 1) {
+            if (abs(row[x] - first[x % 4]) > SOLID_TOLERANCE) {
+                image.solid = false;
+                break;
+            }
+            sums[x % 4] += row[x];
         }
     }
-    return -1;
+    if (image.solid) {
+        unsigned long long pixels = max(1ull, (unsigned long long) imageSurface->w * imageSurface->h);
+        for (unsigned int c = 0; c < 4; c += 1) {
+            image.color[c] = (sums[c] + pixels / 2) / pixels;
+        }
+        SDL_FreeSurface(imageSurface);
+    } else if (imageSurface->w + 2 > ATLAS_WIDTH) {
+        cerr << "Unable to load the image " << name
+                << " due to: it is too wide for the atlas" << endl;
+        SDL_FreeSurface(imageSurface);
+        return -1;
+    } else {
+        // The pixels are kept until the atlas is built
+        image.surface = imageSurface;
+        atlasDirty_ = true;
+    }
+    images_.push_back(image);
+    return images_.size() - 1;
 }
 
 unsigned int Display::getImageCount() const noexcept {
     return images_.size();
 }
 
-shared_ptr<Request> Display::getNextRequest() noexcept {
+void Display::pollEvents(EventQueue& events) noexcept {
 
-    // Remove one event from the queue
+    // Take events from the queue while there is room
+    // for them, so none are lost
 
+    bool titleChanged = false;
     SDL_Event event;
-    while (SDL_PollEvent(&event) != 0) {
+    while (!events.full() && SDL_PollEvent(&event) != 0) {
 
-        // The type determines what kind of request
+        // The type determines what kind of input
         // occurred
 
         switch (event.type) {
@@ -135,16 +182,17 @@ shared_ptr<Request> Display::getNextRequest() noexcept {
 
             case SDL_QUIT:
                 close();
-                return make_shared<QuitRequest>();
+                events.push({InputType::Quit, 0, 0});
+                return;
 
                 // The user pressed a mouse button
 
             case SDL_MOUSEBUTTONDOWN:
                 if (event.button.button == SDL_BUTTON_LEFT) {
-                    const string title = "Fired towards: (" +
-                            to_string(event.button.x) + ", " + to_string(event.button.y) + ")";
-                    SDL_SetWindowTitle(window_, title.c_str());
-                    return make_shared<ButtonRequest>(event.button.x, event.button.y, true);
+                    snprintf(title_, sizeof(title_), "Fired towards: (%d, %d)",
+                            event.button.x, event.button.y);
+                    titleChanged = true;
+                    events.push({InputType::Press, event.button.x, event.button.y});
                 }
                 break;
 
@@ -152,15 +200,17 @@ shared_ptr<Request> Display::getNextRequest() noexcept {
 
             case SDL_MOUSEBUTTONUP:
                 if (event.button.button == SDL_BUTTON_LEFT) {
-                    return make_shared<ButtonRequest>(event.button.x, event.button.y, false);
+                    events.push({InputType::Release, event.button.x, event.button.y});
                 }
                 break;
 
             case SDL_KEYDOWN:
                 switch (event.key.keysym.sym) {
                     case SDLK_SPACE:
-                        SDL_SetWindowTitle(window_, "Level reset");
-                        return make_shared<RestartRequest>();
+                        snprintf(title_, sizeof(title_), "Level reset");
+                        titleChanged = true;
+                        events.push({InputType::Restart, 0, 0});
+                        break;
                     default:
                         break;
                 }
@@ -172,58 +222,191 @@ shared_ptr<Request> Display::getNextRequest() noexcept {
                 break;
         }
     }
-    return shared_ptr<Request>();
+
+    // Only show the last input in the title, which
+    // is a round trip to the window manager
+
+    if (titleChanged) {
+        SDL_SetWindowTitle(window_, title_);
+    }
 }
 
-void Display::refresh(const vector<ImageObject>& images) {
+void Display::refresh(const DrawCommand* commands, size_t count, double alpha) {
     if (renderer_) {
+        if (atlasDirty_) {
+            buildAtlas();
+        }
+        auto start = chrono::steady_clock::now();
+        {
+            DEFLECTION_TRACE_SCOPE("refresh/build");
+
+            // Sort the corners of the objects into the
+            // batch of single colors or of the atlas,
+            // checking each image index as it is used
+
+            solidVertices_.clear();
+            atlasVertices_.clear();
+            for (size_t i = 0; i < count; i += 1) {
+                const DrawCommand& command = commands[i];
+                unsigned int imageIndex = command.imageIndex;
+                if (imageIndex >= images_.size()) {
+                    close();
+                    throw domain_error("Invalid image index "
+                            + to_string(imageIndex));
+                }
+                const Image& image = images_[imageIndex];
+
+                // Place the object between its previous and
+                // current center. The corners are the top
+                // left, top right, bottom right and bottom
+                // left of the image, rotated by its angle.
+                // Single colors are drawn with the color of
+                // their vertices and no texture, and the
+                // others with their rectangle of the atlas.
+
+                float x = command.prevX + (command.x - command.prevX) * alpha;
+                float y = command.prevY + (command.y - command.prevY) * alpha;
+                vector<SDL_Vertex>& batch = image.solid ? solidVertices_ : atlasVertices_;
+                SDL_Color color = {0xff, 0xff, 0xff, 0xff};
+                if (image.solid) {
+                    color = {image.color[0], image.color[1], image.color[2], image.color[3]};
+                }
+                for (unsigned int c = 0; c < 4; c += 1) {
+                    SDL_Vertex vertex;
+                    vertex.position.x = x + command.cornerX[c];
+                    vertex.position.y = y + command.cornerY[c];
+                    vertex.color = color;
+                    vertex.tex_coord.x = image.uv[(c == 1 || c == 2) ? 2 : 0];
+                    vertex.tex_coord.y = image.uv[(c >= 2) ? 3 : 1];
+                    batch.push_back(vertex);
+                }
+            }
 
-        // Clear the window
+            // Every quad is the same two triangles of its
+            // four corners
 
-        clearBackground();
+            size_t largestBatch = max(solidVertices_.size(), atlasVertices_.size()) / 4;
+            for (size_t quad = quadIndices_.size() / 6; quad < largestBatch; quad += 1) {
+                int first = quad * 4;
+                quadIndices_.insert(quadIndices_.end(),
+                        {first, first + 1, first + 2, first + 2, first + 3, first});
+            }
+        }
+        auto built = chrono::steady_clock::now();
+
+        // Clear the window and draw each batch with a
+        // single call
+
+        unsigned int drawCalls = 0;
+        {
+            DEFLECTION_TRACE_SCOPE("refresh/submit");
+            clearBackground();
+            SDL_Texture* textures[2] = {nullptr, atlas_};
+            const vector<SDL_Vertex>* batches[2] = {&solidVertices_, &atlasVertices_};
+            for (unsigned int b = 0; b < 2; b += 1) {
+                const vector<SDL_Vertex>& batch = *batches[b];
+                if (batch.empty()) {
+                    continue;
+                }
+                if (SDL_RenderGeometry(renderer_, textures[b], batch.data(), batch.size(),
+                        quadIndices_.data(), batch.size() / 4 * 6) != 0) {
+                    close();
+                    throw domain_error(string("Unable to render the objects due to: ")
+                            + SDL_GetError());
+                }
+                drawCalls += 1;
+            }
+        }
+        auto submitted = chrono::steady_clock::now();
+        {
+            // Presenting waits for the GPU and, with vsync,
+            // for the display
+            DEFLECTION_TRACE_SCOPE("refresh/present");
+            SDL_RenderPresent(renderer_);
+        }
+        auto presented = chrono::steady_clock::now();
 
-        // Draw all of the ImageObjects
+        stats_.objects = count;
+        stats_.drawCalls = drawCalls;
+        stats_.buildSeconds = chrono::duration<double>(built - start).count();
+        stats_.submitSeconds = chrono::duration<double>(submitted - built).count();
+        stats_.presentSeconds = chrono::duration<double>(presented - submitted).count();
+    }
+}
 
-        for (const ImageObject& i : images) {
+const RenderStats& Display::getRenderStats() const noexcept {
+    return stats_;
+}
 
-            // The location of the ImageObject is a square
+void Display::buildAtlas() {
 
-            SDL_Rect destination = {i.getTopLeftXCoordinate(), i.getTopLeftYCoordinate(),
-                i.getWidth(), i.getLength()};
+    // Place the images left to right in rows, each
+    // as tall as its tallest image
+
+    int x = 1;
+    int y = 1;
+    int rowHeight = 0;
+    vector<SDL_Rect> places(images_.size());
+    for (size_t i = 0; i < images_.size(); i += 1) {
+        const SDL_Surface* surface = images_[i].surface;
+        if (!surface) {
+            continue;
+        }
+        if (x + surface->w + 1 > ATLAS_WIDTH) {
+            x = 1;
+            y += rowHeight + 1;
+            rowHeight = 0;
+        }
+        places[i] = {x, y, surface->w, surface->h};
+        x += surface->w + 1;
+        rowHeight = max(rowHeight, surface->h);
+    }
+    int height = y + rowHeight + 1;
 
-            // Get the image index and check that it is valid
+    // Copy the pixels of each image into its place
 
-            unsigned int imageIndex = i.getImageIndex();
-            if (imageIndex < images_.size()) {
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, height, 32,
+            SDL_PIXELFORMAT_RGBA32);
+    if (!atlas) {
+        close();
+        throw domain_error(string("Unable to create the atlas due to: ") + SDL_GetError());
+    }
+    for (size_t i = 0; i < images_.size(); i += 1) {
+        const SDL_Surface* surface = images_[i].surface;
+        if (!surface) {
+            continue;
+        }
+        const SDL_Rect& place = places[i];
+        for (int row = 0; row < surface->h; row += 1) {
+            memcpy(static_cast<unsigned char*>(atlas->pixels) + (place.y + row) * atlas->pitch
+                    + place.x * 4,
+                    static_cast<const unsigned char*>(surface->pixels) + row * surface->pitch,
+                    surface->w * 4);
+        }
 
-                // Get the image for the ImageObject
+        // The coordinates are half a pixel inside the
+        // edges, so filtering only samples the image
 
-                SDL_Texture* imageTexture = images_.at(imageIndex);
-                if (imageTexture) {
+        float* uv = images_[i].uv;
+        uv[0] = (place.x + 0.5f) / ATLAS_WIDTH;
+        uv[1] = (place.y + 0.5f) / height;
+        uv[2] = (place.x + place.w - 0.5f) / ATLAS_WIDTH;
+        uv[3] = (place.y + place.h - 0.5f) / height;
+    }
 
-                    // Render the image at the location,
-                    // rotated by its angle
+    // Replace the atlas texture
 
-                    if (SDL_RenderCopyEx(renderer_, imageTexture, nullptr,
-                            &destination, i.getAngle(),
-                            nullptr, SDL_FLIP_NONE) != 0) {
-                        close();
-                        throw domain_error(string("Unable to render a ImageObject due to: ")
-                                + SDL_GetError());
-                    }
-                } else {
-                    close();
-                    throw domain_error("Missing image texture at index "
-                            + to_string(imageIndex));
-                }
-            } else {
-                close();
-                throw domain_error("Invalid image index "
-                        + to_string(imageIndex));
-            }
-        }
-        SDL_RenderPresent(renderer_);
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, atlas);
+    SDL_FreeSurface(atlas);
+    if (!texture) {
+        close();
+        throw domain_error(string("Unable to create the atlas due to: ") + SDL_GetError());
+    }
+    if (atlas_) {
+        SDL_DestroyTexture(atlas_);
     }
+    atlas_ = texture;
+    atlasDirty_ = false;
 }
 
 void Display::clearBackground() {
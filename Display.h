@@ -1,16 +1,43 @@
 #ifndef DEFLECTION_DISPLAY_H
 #define DEFLECTION_DISPLAY_H
 
-#include <memory>
-#include "ImageObject.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "DrawCommand.h"
+#include "EventQueue.h"
 
 class SDL_Window;
 class SDL_Renderer;
 class SDL_Texture;
+struct SDL_Surface;
+struct SDL_Vertex;
 
 namespace deflection {
 
-class Request;
+/**
+ * The cost of the last frame drawn by a Display.
+ */
+struct RenderStats {
+
+    /** The number of objects drawn. */
+    unsigned int objects = 0;
+
+    /** The number of draw calls submitted to the renderer. */
+    unsigned int drawCalls = 0;
+
+    /** The CPU time spent building the vertices of the frame, in seconds. */
+    double buildSeconds = 0.0;
+
+    /** The time spent clearing and submitting the draw calls, in seconds. */
+    double submitSeconds = 0.0;
+
+    /**
+     * The time spent presenting the frame, in seconds, which includes waiting
+     * for the GPU and, with vsync, for the display.
+     */
+    double presentSeconds = 0.0;
+};
 
 /**
  * SDL Display. The purpose of this class is to
@@ -45,33 +72,69 @@ public:
     void close() noexcept;
 
     /**
-     * Add an image to the collection.
+     * Add an image to the collection. An image of a
+     * single color is drawn as flat colored quads
+     * without a texture. Other images are packed
+     * into a single atlas texture, which is built
+     * before the next refresh.
+     * @return the index of the image, or -1 if it
+     * could not be loaded.
      */
     int addImage(/** The location of the file. */
             const std::string& fileLocation) noexcept;
 
+    /**
+     * Add an image to the collection from a BMP in
+     * memory, such as one compiled into the program,
+     * in the same way as from a file.
+     * @return the index of the image, or -1 if it
+     * could not be loaded.
+     */
+    int addImage(/** The bytes of the BMP. */
+            const unsigned char* data,
+            /** The number of bytes. */
+            std::size_t size,
+            /** The name of the image, for errors. */
+            const std::string& name) noexcept;
+
     /**
      * Get the number of images.
      */
     unsigned int getImageCount() const noexcept;
 
     /**
-     * Get the next request from the user.  If quit
-     * is requested, the display is closed and
-     * deleted.  If a button is pressed, then the
-     * window title is changed.
-     * @return The request event that occurred or
-     * null if no event occurred.  
+     * Add the pending input from the user to the
+     * queue, until there is none left or the queue
+     * is full, in which case the rest is left for the
+     * next call.  If quit is requested, the display
+     * is closed.  The window title shows the last
+     * input, and is changed at most once per call.
      */
-    std::shared_ptr<Request> getNextRequest() noexcept;
+    void pollEvents(/** The queue to add the input to. */
+            EventQueue& events) noexcept;
 
     /**
-     * Refresh the display.
+     * Refresh the display. The objects are drawn in
+     * at most two draw calls, first all the objects
+     * with single color images, then all the objects
+     * with images in the atlas, each in the order of
+     * the commands. Each object is drawn between its
+     * previous and current center.
      * @throw domain_error if the display could not
      * be refreshed.
      */
-    void refresh(/** The ImageObjects to display. */
-            const std::vector<ImageObject>& images);
+    void refresh(/** The DrawCommands of the objects to display. */
+            const DrawCommand* commands,
+            /** The number of DrawCommands. */
+            std::size_t count,
+            /** How far between the previous and current
+             * centers to draw objects, from 0 to 1. */
+            double alpha);
+
+    /**
+     * Get the cost of the last frame drawn.
+     */
+    const RenderStats& getRenderStats() const noexcept;
 
 private:
     /** The display window. */
@@ -80,8 +143,43 @@ private:
     /** The display rendering tool. */
     SDL_Renderer* renderer_ = nullptr;
 
+    /**
+     * An image of the collection, either a single
+     * color or a rectangle of the atlas.
+     */
+    struct Image {
+        /** Whether the image is a single color. */
+        bool solid;
+
+        /** The red, green, blue and alpha of a single color image. */
+        unsigned char color[4];
+
+        /** The RGBA32 pixels of an atlas image, kept to rebuild the atlas. */
+        SDL_Surface* surface;
+
+        /** The left, top, right and bottom texture coordinates in the atlas. */
+        float uv[4];
+    };
+
+    /** The width of the atlas, which grows downwards. */
+    static constexpr int ATLAS_WIDTH = 2048;
+
+    /**
+     * The most a channel of a pixel may differ from
+     * the first pixel for an image to still be a
+     * single color, so dithered or rounded flat
+     * images qualify.
+     */
+    static constexpr int SOLID_TOLERANCE = 2;
+
     /** The collection of images. */
-    std::vector<SDL_Texture*> images_;
+    std::vector<Image> images_;
+
+    /** The texture all images that are not single colors are packed into. */
+    SDL_Texture* atlas_ = nullptr;
+
+    /** Whether images were added since the atlas was built. */
+    bool atlasDirty_ = false;
 
     /** The width of the window. */
     const int width_ = 0;
@@ -89,6 +187,55 @@ private:
     /** The height of the window. */
     const int height_ = 0;
 
+    /**
+     * The vertices of the rotated corners of the
+     * objects with single color images, kept between
+     * frames so that their memory is reused.
+     */
+    std::vector<SDL_Vertex> solidVertices_;
+
+    /**
+     * The vertices of the rotated corners of the
+     * objects with images in the atlas.
+     */
+    std::vector<SDL_Vertex> atlasVertices_;
+
+    /**
+     * The indices of the two triangles of each quad,
+     * shared by both batches.
+     */
+    std::vector<int> quadIndices_;
+
+    /** The cost of the last frame drawn. */
+    RenderStats stats_;
+
+    /**
+     * The window title showing the last input,
+     * written without allocating.
+     */
+    char title_[64] = "";
+
+    /**
+     * Add a loaded image to the collection, taking
+     * ownership of it.
+     * @return the index of the image, or -1 if it
+     * is nullptr or could not be converted.
+     */
+    int addSurface(/** The image, or nullptr if loading failed. */
+            SDL_Surface* loaded,
+            /** The name of the image, for errors. */
+            const std::string& name) noexcept;
+
+    /**
+     * Pack the images that are not single colors into
+     * rows of a new atlas texture, with a pixel of
+     * space between them so that filtering does not
+     * bleed between neighbours.
+     * @throw domain_error if the atlas could not be
+     * created.
+     */
+    void buildAtlas();
+
     /**
      * Clear the background to opaque white.
      */
@@ -0,0 +1,41 @@
+#ifndef DRAWCOMMAND_H
+#define DRAWCOMMAND_H
+
+namespace deflection {
+
+/**
+ * A plain record of one object for the Display to draw. The corners are kept
+ * relative to the center, so an object that moves only has its center
+ * updated, and the Display places it between its previous and current center.
+ *
+ * @author Trevor Day
+ */
+struct DrawCommand {
+
+    /** The index of the image to draw the object with. */
+    unsigned int imageIndex;
+
+    /** The x coordinate of the center of the object. */
+    float x;
+
+    /** The y coordinate of the center of the object. */
+    float y;
+
+    /** The x coordinate of the center before the last update. */
+    float prevX;
+
+    /** The y coordinate of the center before the last update. */
+    float prevY;
+
+    /**
+     * The x coordinates of the top left, top right, bottom right and bottom
+     * left corners of the image, rotated and relative to the center.
+     */
+    float cornerX[4];
+
+    /** The y coordinates of the corners, in the same order as cornerX. */
+    float cornerY[4];
+};
+}
+
+#endif /* DRAWCOMMAND_H */
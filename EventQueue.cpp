@@ -0,0 +1,29 @@
+#include "EventQueue.h"
+
+using namespace std;
+using namespace deflection;
+
+bool EventQueue::push(const InputEvent& event) noexcept {
+    if (size_ == CAPACITY) {
+        return false;
+    }
+    events_[size_] = event;
+    size_ += 1;
+    return true;
+}
+
+bool EventQueue::full() const noexcept {
+    return size_ == CAPACITY;
+}
+
+unsigned int EventQueue::size() const noexcept {
+    return size_;
+}
+
+const InputEvent& EventQueue::operator[](unsigned int i) const noexcept {
+    return events_[i];
+}
+
+void EventQueue::clear() noexcept {
+    size_ = 0;
+}
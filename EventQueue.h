@@ -0,0 +1,95 @@
+#ifndef EVENTQUEUE_H
+#define EVENTQUEUE_H
+
+#include <array>
+
+namespace deflection {
+
+/**
+ * The kinds of input from the user.
+ */
+enum class InputType {
+
+    /** The user closed the window. */
+    Quit,
+
+    /** The user pressed the left mouse button. */
+    Press,
+
+    /** The user released the left mouse button. */
+    Release,
+
+    /** The user asked for a new level. */
+    Restart
+};
+
+/**
+ * An input from the user, held by value.
+ */
+struct InputEvent {
+
+    /** The kind of input. */
+    InputType type;
+
+    /** The x coordinate of the mouse, for Press and Release. */
+    int x;
+
+    /** The y coordinate of the mouse, for Press and Release. */
+    int y;
+};
+
+/**
+ * A queue of InputEvents with a fixed capacity, filled by the Display and
+ * drained once per frame. It never allocates, so input at any rate costs
+ * nothing beyond copying the events.
+ *
+ * @author Trevor Day
+ */
+class EventQueue {
+public:
+
+    /** The most events the queue holds. */
+    static constexpr unsigned int CAPACITY = 256;
+
+    /**
+     * Adds an event to the end of the queue, if it is not full.
+     * @param event is the InputEvent to add.
+     * @return true if the event was added, false if the queue was full.
+     */
+    bool push(const InputEvent& event) noexcept;
+
+    /**
+     * Returns whether the queue is full.
+     * @return true if no more events can be added.
+     */
+    bool full() const noexcept;
+
+    /**
+     * Returns the number of events in the queue.
+     * @return an unsigned int representing the number of events.
+     */
+    unsigned int size() const noexcept;
+
+    /**
+     * Returns the event at the given index, in the order they were added.
+     * @param i is the index of the event.
+     * @return a const reference to the InputEvent.
+     */
+    const InputEvent& operator[](unsigned int i) const noexcept;
+
+    /**
+     * Removes all the events.
+     */
+    void clear() noexcept;
+
+private:
+
+    /** The events in the queue, of which the first size_ are used. */
+    std::array<InputEvent, CAPACITY> events_;
+
+    /** The number of events in the queue. */
+    unsigned int size_ = 0;
+};
+}
+
+#endif /* EVENTQUEUE_H */
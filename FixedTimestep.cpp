@@ -0,0 +1,35 @@
+#include "FixedTimestep.h"
+
+using namespace deflection;
+
+FixedTimestep::FixedTimestep(double tickRate, unsigned int maxTicksPerFrame) noexcept
+: tickSeconds_(1.0 / tickRate), maxTicksPerFrame_(maxTicksPerFrame) {
+}
+
+unsigned int FixedTimestep::advance(double seconds) noexcept {
+    accumulator_ += seconds;
+    unsigned long long ticks = (unsigned long long) (accumulator_ / tickSeconds_);
+    accumulator_ -= ticks * tickSeconds_;
+    if (accumulator_ < 0.0) {
+        accumulator_ = 0.0;
+    }
+    if (ticks > maxTicksPerFrame_) {
+        // Catching up on all of them would make the next frame even later,
+        // so the time is dropped instead
+        droppedTicks_ += ticks - maxTicksPerFrame_;
+        ticks = maxTicksPerFrame_;
+    }
+    return ticks;
+}
+
+double FixedTimestep::getAlpha() const noexcept {
+    return accumulator_ / tickSeconds_;
+}
+
+double FixedTimestep::getTickSeconds() const noexcept {
+    return tickSeconds_;
+}
+
+unsigned long long FixedTimestep::getDroppedTicks() const noexcept {
+    return droppedTicks_;
+}
@@ -0,0 +1,70 @@
+#ifndef FIXEDTIMESTEP_H
+#define FIXEDTIMESTEP_H
+
+namespace deflection {
+
+/**
+ * Converts the real time between frames into a number of simulation ticks of
+ * a fixed length, using an accumulator, so that the speed of the game does not
+ * depend on the frame rate. Time left over after the last whole tick is kept
+ * for the next frame, and is also used to interpolate drawing between the last
+ * two ticks.
+ *
+ * @author Trevor Day
+ */
+class FixedTimestep {
+public:
+
+    /**
+     * Constructs a new FixedTimestep with the given parameters.
+     * @param tickRate is the number of ticks per second.
+     * @param maxTicksPerFrame is the most ticks run for a single frame. When a
+     * frame takes longer than this many ticks, the rest of its time is dropped
+     * and the game slows down instead of falling further and further behind.
+     */
+    FixedTimestep(double tickRate = 60.0, unsigned int maxTicksPerFrame = 5) noexcept;
+
+    /**
+     * Adds the given real time to the accumulator, and returns the number of
+     * whole ticks that should be run for it.
+     * @param seconds is the real time since the last call, in seconds.
+     * @return an unsigned int representing the number of ticks to run.
+     */
+    unsigned int advance(double seconds) noexcept;
+
+    /**
+     * Returns how far the time left in the accumulator is between the last
+     * tick and the next one.
+     * @return a double between 0 and 1.
+     */
+    double getAlpha() const noexcept;
+
+    /**
+     * Returns the length of a tick.
+     * @return a double representing the length of a tick in seconds.
+     */
+    double getTickSeconds() const noexcept;
+
+    /**
+     * Returns the number of ticks dropped so far because frames took too long.
+     * @return an unsigned long long representing the number of ticks dropped.
+     */
+    unsigned long long getDroppedTicks() const noexcept;
+
+private:
+
+    /** The length of a tick in seconds. */
+    const double tickSeconds_;
+
+    /** The most ticks run for a single frame. */
+    const unsigned int maxTicksPerFrame_;
+
+    /** The real time not yet simulated, in seconds. */
+    double accumulator_ = 0.0;
+
+    /** The number of ticks dropped because frames took too long. */
+    unsigned long long droppedTicks_ = 0;
+};
+}
+
+#endif /* FIXEDTIMESTEP_H */
@@ -1,4 +1,5 @@
 #include <cmath>
+#include <limits>
 #include "ImageObject.h"
 
 // A definition of pi
@@ -9,7 +10,34 @@ using namespace deflection;
 
 ImageObject::ImageObject(unsigned int imageIndex, double x, double y,
         double width, double length, double angle) noexcept
-: imageIndex_(imageIndex), cx_(x), cy_(y), width_(width), length_(length), angle_(angle) {
+: imageIndex_(imageIndex), cx_(x), cy_(y), width_(width), length_(length), angle_(angle),
+cos_(cos(angle * PI / 180.0)), sin_(sin(angle * PI / 180.0)) {
+
+    // Get half the width, half the length
+    double halfWidth = width_ / 2.0;
+    double halfLength = length_ / 2.0;
+    double c = cos_;
+    double s = sin_;
+
+    // The top left, top right, bottom right, and bottom left rotated corners,
+    // relative to the center
+    offsets_ = Quad{{
+        {((0 - halfWidth) * c) - ((0 - halfLength) * s),
+            ((0 - halfWidth) * s) + ((0 - halfLength) * c)},
+        {(halfWidth * c) - ((0 - halfLength) * s),
+            (halfWidth * s) + ((0 - halfLength) * c)},
+        {(halfWidth * c) - (halfLength * s),
+            (halfWidth * s) + (halfLength * c)},
+        {((0 - halfWidth) * c) - (halfLength * s),
+            ((0 - halfWidth) * s) + (halfLength * c)}
+    }};
+
+    // The normals do not depend on the center, and neither do the extents
+    // along them once the center is taken away
+    normals_ = getAxes(offsets_);
+    offsetExtents_[0] = project(offsets_, normals_[0]);
+    offsetExtents_[1] = project(offsets_, normals_[1]);
+    updateGeometry();
 }
 
 int ImageObject::getTopLeftXCoordinate() const noexcept {
@@ -20,6 +48,14 @@ int ImageObject::getTopLeftYCoordinate() const noexcept {
     return int(cy_ - (length_ / 2.0) + 0.5);
 }
 
+double ImageObject::getCenterX() const noexcept {
+    return cx_;
+}
+
+double ImageObject::getCenterY() const noexcept {
+    return cy_;
+}
+
 int ImageObject::getWidth() const noexcept {
     return int(width_);
 }
@@ -36,56 +72,57 @@ double ImageObject::getAngle() const noexcept {
     return angle_;
 }
 
-vector<pair<double, double> > ImageObject::getVertices() const noexcept {
-
-    // Get half the width, half the length
-    double halfWidth = width_ / 2.0;
-    double halfLength = length_ / 2.0;
-    double angle = angle_ * PI / 180.0;
-
-    // Get the top left rotated corner
-    double X1 = (((0 - halfWidth) * cos(angle)) - ((0 - halfLength) * sin(angle))) + cx_;
-    double Y1 = (((0 - halfWidth) * sin(angle)) + ((0 - halfLength) * cos(angle))) + cy_;
-
-    // Get the top right rotated corner
-    double X2 = ((halfWidth * cos(angle)) - ((0 - halfLength) * sin(angle))) + cx_;
-    double Y2 = ((halfWidth * sin(angle)) + ((0 - halfLength) * cos(angle))) + cy_;
+const Quad& ImageObject::getVertices() const noexcept {
+    refreshGeometry();
+    return vertices_;
+}
 
-    // Get the bottom right rotated corner
-    double X3 = ((halfWidth * cos(angle)) - (halfLength * sin(angle))) + cx_;
-    double Y3 = ((halfWidth * sin(angle)) + (halfLength * cos(angle))) + cy_;
+const Quad& ImageObject::getNormals() const noexcept {
+    refreshGeometry();
+    return normals_;
+}
 
-    // Get the bottom left rotated corner
-    double X4 = (((0 - halfWidth) * cos(angle)) - (halfLength * sin(angle))) + cx_;
-    double Y4 = (((0 - halfWidth) * sin(angle)) + (halfLength * cos(angle))) + cy_;
+void ImageObject::setCenter(double x, double y) noexcept {
+    cx_ = x;
+    cy_ = y;
+    dirty_ = true;
+}
 
-    // Create a vector to add the points to
-    vector<pair<double, double> > points1;
-    points1.push_back(make_pair(X1, Y1));
-    points1.push_back(make_pair(X2, Y2));
-    points1.push_back(make_pair(X3, Y3));
-    points1.push_back(make_pair(X4, Y4));
+void ImageObject::refreshGeometry() const noexcept {
+    if (dirty_) {
+        updateGeometry();
+    }
+}
 
-    // Return the points
-    return points1;
+void ImageObject::updateGeometry() const noexcept {
+    // Moving only translates the shape, so the vertices and the extents are
+    // the ones around the center, shifted to the current center
+    Vec2 center = {cx_, cy_};
+    for (unsigned int i = 0; i < vertices_.size(); i += 1) {
+        vertices_[i] = {offsets_[i].x + cx_, offsets_[i].y + cy_};
+    }
+    for (unsigned int i = 0; i < 2; i += 1) {
+        double shift = dotProduct(center, normals_[i]);
+        extents_[i] = make_pair(get<0>(offsetExtents_[i]) + shift, get<1>(offsetExtents_[i]) + shift);
+    }
+    dirty_ = false;
 }
 
-double ImageObject::dotProduct(pair<double, double> one, pair<double, double> two) noexcept {
+double ImageObject::dotProduct(Vec2 one, Vec2 two) noexcept {
     // Multiply X1 by X2 and add it to Y1 multiplied by Y2
-    return (get<0>(one) * get<0>(two)) + (get<1>(one) * get<1>(two));
+    return (one.x * two.x) + (one.y * two.y);
 }
 
-pair<double, double> ImageObject::project(vector<pair<double, double> > points,
-        pair<double, double> axis) noexcept {
+pair<double, double> ImageObject::project(const Quad& points, Vec2 axis) noexcept {
 
     // Set the min and max to the first
-    double minProj = dotProduct(points.at(0), axis);
-    double maxProj = dotProduct(points.at(0), axis);
+    double minProj = dotProduct(points[0], axis);
+    double maxProj = minProj;
 
     // Iterate through points, project them, and check if the min is less, or
     // the max is more, and if so set them to that
     for (unsigned int i = 1; i < points.size(); i += 1) {
-        double currProj = dotProduct(points.at(i), axis);
+        double currProj = dotProduct(points[i], axis);
         if (currProj < minProj) {
             minProj = currProj;
         }
@@ -98,19 +135,13 @@ pair<double, double> ImageObject::project(vector<pair<double, double> > points,
     return make_pair(minProj, maxProj);
 }
 
-vector<pair<double, double> > ImageObject::getAxes(vector<pair<double, double> > points1) noexcept {
-    // Make a vector to hold axes
-    vector<pair<double, double> > axes1;
+Quad ImageObject::getAxes(const Quad& points1) noexcept {
+    Quad axes1;
     //Iterate through all the points, creating the axes from the normals of the points
     for (unsigned int i = 0; i < points1.size(); i += 1) {
-        if (i + 1 == points1.size()) {
-            // Equation for normals: get the perpendicular vector of the line
-            axes1.push_back(make_pair((0 - (get<1>(points1.at(i)) - get<1>(points1.at(0)))),
-                    get<0>(points1.at(i)) - get<0>(points1.at(0))));
-        } else {
-            axes1.push_back(make_pair((0 - (get<1>(points1.at(i)) - get<1>(points1.at(i + 1)))),
-                    get<0>(points1.at(i)) - get<0>(points1.at(i + 1))));
-        }
+        const Vec2& next = points1[(i + 1) % points1.size()];
+        // Equation for normals: get the perpendicular vector of the line
+        axes1[i] = {0 - (points1[i].y - next.y), points1[i].x - next.x};
     }
     return axes1;
 }
@@ -119,25 +150,18 @@ bool ImageObject::hits(const ImageObject& other) const noexcept {
 
     // Checks for collision using separating axis theorem,
     // which takes all axes of both polygons, projects them across the axes,
-    // and if they ever do not overlap, they are not colliding
+    // and if they ever do not overlap, they are not colliding. Opposite sides
+    // of a rectangle have opposite normals, so only the first two normals of
+    // each object need to be tested.
 
-    // Get the points for this object
-    vector<pair<double, double> > points1 = getVertices();
+    refreshGeometry();
+    other.refreshGeometry();
 
-    // Get the axes for this object
-    vector<pair<double, double> > axes1 = getAxes(points1);
-
-    // Get the points for the other object
-    vector<pair<double, double> > points2 = other.getVertices();
-
-    // Get the axes for the other object
-    vector<pair<double, double> > axes2 = getAxes(points2);
-
-    // Project all points of both polygons across all axes of the first polygon
-    // and check to make sure they always overlap
-    for (unsigned int i = 0; i < axes1.size(); i += 1) {
-        pair<double, double> P1 = project(points1, axes1.at(i));
-        pair<double, double> P2 = project(points2, axes1.at(i));
+    // Project the other polygon across the axes of this polygon, whose own
+    // extents are cached, and check to make sure they always overlap
+    for (unsigned int i = 0; i < 2; i += 1) {
+        const pair<double, double>& P1 = extents_[i];
+        pair<double, double> P2 = project(other.vertices_, normals_[i]);
 
         // If they ever do not overlap return false
         if (get<1>(P1) < get<0>(P2) || get<1>(P2) < get<0>(P1)) {
@@ -145,11 +169,10 @@ bool ImageObject::hits(const ImageObject& other) const noexcept {
         }
     }
 
-    // Project all points of both polygons across all axes of the second polygon
-    // and check to make sure they always overlap
-    for (unsigned int i = 0; i < axes2.size(); i += 1) {
-        pair<double, double> P1 = project(points1, axes2.at(i));
-        pair<double, double> P2 = project(points2, axes2.at(i));
+    // Project this polygon across the axes of the other polygon
+    for (unsigned int i = 0; i < 2; i += 1) {
+        pair<double, double> P1 = project(vertices_, other.normals_[i]);
+        const pair<double, double>& P2 = other.extents_[i];
 
         // If they ever do not overlap return false
         if (get<1>(P1) < get<0>(P2) || get<1>(P2) < get<0>(P1)) {
@@ -161,16 +184,144 @@ bool ImageObject::hits(const ImageObject& other) const noexcept {
     return true;
 }
 
-double ImageObject::lineDistance(pair<double, double> point,
-        pair<double, double> linePoint1, pair<double, double> linePoint2) noexcept {
-    double X0 = get<0>(point);
-    double Y0 = get<1>(point);
+template <>
+bool ImageObject::hits<AxisAligned, AxisAligned>(const ImageObject& other) const noexcept {
+    // The sides are parallel, so the boxes overlap along an axis when the
+    // distance between their centers is no more than their half sizes
+    return abs(cx_ - other.cx_) <= (width_ + other.width_) / 2.0
+            && abs(cy_ - other.cy_) <= (length_ + other.length_) / 2.0;
+}
 
-    double X1 = get<0>(linePoint1);
-    double Y1 = get<1>(linePoint1);
+template <>
+bool ImageObject::hits<AxisAligned, Oriented>(const ImageObject& other) const noexcept {
+    // The same test as WallGrid::hitMask, one pair at a time. Along each
+    // axis, the half extent of a box is the sum of its half sides scaled by
+    // how far they point along the axis.
+    double halfWidth = width_ / 2.0;
+    double halfLength = length_ / 2.0;
+    double otherHalfWidth = other.width_ / 2.0;
+    double otherHalfLength = other.length_ / 2.0;
+    double c = abs(other.cos_);
+    double s = abs(other.sin_);
+    double dx = cx_ - other.cx_;
+    double dy = cy_ - other.cy_;
+
+    // The x and y axes of this box
+    if (abs(dx) > halfWidth + otherHalfWidth * c + otherHalfLength * s
+            || abs(dy) > halfLength + otherHalfWidth * s + otherHalfLength * c) {
+        return false;
+    }
 
-    double X2 = get<0>(linePoint2);
-    double Y2 = get<1>(linePoint2);
+    // The axes along the width and the length of the other box
+    return abs(dx * other.cos_ + dy * other.sin_) <= otherHalfWidth + halfWidth * c + halfLength * s
+            && abs(dy * other.cos_ - dx * other.sin_) <= otherHalfLength + halfWidth * s + halfLength * c;
+}
+
+template <>
+bool ImageObject::hits<Oriented, AxisAligned>(const ImageObject& other) const noexcept {
+    return other.hits<AxisAligned, Oriented>(*this);
+}
+
+Contact ImageObject::contact(const ImageObject& other) const noexcept {
+    refreshGeometry();
+    other.refreshGeometry();
+
+    // Project both polygons across the first two normals of each, as in hits,
+    // keeping the axis they overlap least along
+    Contact result = {false, {0.0, 0.0}, numeric_limits<double>::infinity()};
+    const Quad* normals[2] = {&normals_, &other.normals_};
+    for (const Quad* axes : normals) {
+        for (unsigned int i = 0; i < 2; i += 1) {
+            const Vec2& axis = (*axes)[i];
+            pair<double, double> P1 = project(vertices_, axis);
+            pair<double, double> P2 = project(other.vertices_, axis);
+            double overlap = min(get<1>(P1), get<1>(P2)) - max(get<0>(P1), get<0>(P2));
+            if (overlap < 0.0) {
+                return {false, {0.0, 0.0}, 0.0};
+            }
+
+            // The normals are as long as their sides, so the overlap is
+            // scaled down to pixels
+            double length = sqrt(dotProduct(axis, axis));
+            if (overlap / length < result.depth) {
+                result.depth = overlap / length;
+                result.normal = {axis.x / length, axis.y / length};
+            }
+        }
+    }
+
+    // Point the normal from the other object towards this one
+    Vec2 d = {cx_ - other.cx_, cy_ - other.cy_};
+    if (dotProduct(d, result.normal) < 0.0) {
+        result.normal = {-result.normal.x, -result.normal.y};
+    }
+    result.hit = true;
+    return result;
+}
+
+template <>
+Contact ImageObject::contact<AxisAligned, AxisAligned>(const ImageObject& other) const noexcept {
+    // The overlap along each axis is the half sizes less the distance between
+    // the centers, and the contact is along the axis with the least
+    double dx = cx_ - other.cx_;
+    double dy = cy_ - other.cy_;
+    double overlapX = (width_ + other.width_) / 2.0 - abs(dx);
+    double overlapY = (length_ + other.length_) / 2.0 - abs(dy);
+    if (overlapX < 0.0 || overlapY < 0.0) {
+        return {false, {0.0, 0.0}, 0.0};
+    }
+    if (overlapX <= overlapY) {
+        return {true, {dx < 0.0 ? -1.0 : 1.0, 0.0}, overlapX};
+    }
+    return {true, {0.0, dy < 0.0 ? -1.0 : 1.0}, overlapY};
+}
+
+template <>
+Contact ImageObject::contact<AxisAligned, Oriented>(const ImageObject& other) const noexcept {
+    // The same four axes as hits<AxisAligned, Oriented>, all unit vectors,
+    // keeping the overlap along each instead of only its sign
+    double halfWidth = width_ / 2.0;
+    double halfLength = length_ / 2.0;
+    double otherHalfWidth = other.width_ / 2.0;
+    double otherHalfLength = other.length_ / 2.0;
+    double c = abs(other.cos_);
+    double s = abs(other.sin_);
+    double dx = cx_ - other.cx_;
+    double dy = cy_ - other.cy_;
+    const Vec2 axes[4] = {
+        {1.0, 0.0}, {0.0, 1.0}, {other.cos_, other.sin_}, {-other.sin_, other.cos_}
+    };
+    const double reach[4] = {
+        halfWidth + otherHalfWidth * c + otherHalfLength * s,
+        halfLength + otherHalfWidth * s + otherHalfLength * c,
+        otherHalfWidth + halfWidth * c + halfLength * s,
+        otherHalfLength + halfWidth * s + halfLength * c
+    };
+    Contact result = {false, {0.0, 0.0}, numeric_limits<double>::infinity()};
+    for (unsigned int i = 0; i < 4; i += 1) {
+        double distance = dx * axes[i].x + dy * axes[i].y;
+        double overlap = reach[i] - abs(distance);
+        if (overlap < 0.0) {
+            return {false, {0.0, 0.0}, 0.0};
+        }
+        if (overlap < result.depth) {
+            result.depth = overlap;
+            result.normal = distance < 0.0 ? Vec2{-axes[i].x, -axes[i].y} : axes[i];
+        }
+    }
+    result.hit = true;
+    return result;
+}
+
+double ImageObject::lineDistance(Vec2 point, Vec2 linePoint1, Vec2 linePoint2) noexcept {
+    double X0 = point.x;
+    double Y0 = point.y;
+
+    double X1 = linePoint1.x;
+    double Y1 = linePoint1.y;
+
+    double X2 = linePoint2.x;
+    double Y2 = linePoint2.y;
 
     // Equation for determining shortest distance from a point to a line
     // defined by two points
@@ -178,54 +329,44 @@ double ImageObject::lineDistance(pair<double, double> point,
             sqrt(pow(Y2 - Y1, 2) + pow(X2 - X1, 2));
 }
 
-pair<double, double> ImageObject::bounce(const ImageObject& other,
+Vec2 ImageObject::bounce(const ImageObject& other,
         double vx, double vy) const noexcept {
     // Get the vertices of the other object
-    vector<pair<double, double> > points = other.getVertices();
+    const Quad& points = other.getVertices();
 
     // Get the vector of this object
-    pair<double, double> v = make_pair(vx, vy);
+    Vec2 v = {vx, vy};
 
     // Get the center point of this object
-    pair<double, double> center = make_pair(cx_, cy_);
+    Vec2 center = {cx_, cy_};
 
     // Make variables to hold the two closest points, and set them to the first
     // to start
-    pair<double, double> closest1 = points.at(0);
-    pair<double, double> closest2 = points.at(1);
+    Vec2 closest1 = points[0];
+    Vec2 closest2 = points[1];
 
     // Iterate through all the points of this object, checking to see which line
     // of the other object is closest to the center point of this object
     for (unsigned int i = 1; i < points.size(); i += 1) {
-        if (i + 1 == points.size()) {
-            if (lineDistance(center, points.at(i), points.at(0)) <
-                    lineDistance(center, closest1, closest2)) {
-                // If the distance is shorter, set the points defining that line
-                // to the closest two points
-                closest1 = points.at(i);
-                closest2 = points.at(0);
-            }
-        } else {
-            if (lineDistance(center, points.at(i), points.at(i + 1)) <
-                    lineDistance(center, closest1, closest2)) {
-                // If the distance is shorter, set the points defining that line
-                // to the closest two points
-                closest1 = points.at(i);
-                closest2 = points.at(i + 1);
-            }
+        const Vec2& next = points[(i + 1) % points.size()];
+        if (lineDistance(center, points[i], next) <
+                lineDistance(center, closest1, closest2)) {
+            // If the distance is shorter, set the points defining that line
+            // to the closest two points
+            closest1 = points[i];
+            closest2 = next;
         }
     }
 
     // Get the normal of the line formed by the closest points
-    pair<double, double> n = make_pair((0 - (get<1>(closest1) - get<1>(closest2))),
-            get<0>(closest1) - get<0>(closest2));
+    Vec2 n = {0 - (closest1.y - closest2.y), closest1.x - closest2.x};
 
     // Equation for calculating new object velocity after collision
     // with a line
-    pair<double, double> u = make_pair((dotProduct(v, n) / dotProduct(n, n)) * get<0>(n),
-            (dotProduct(v, n) / dotProduct(n, n)) * get<1>(n));
+    double scale = dotProduct(v, n) / dotProduct(n, n);
+    Vec2 u = {scale * n.x, scale * n.y};
 
-    pair<double, double> w = make_pair(get<0>(v) - get<0>(u), get<1>(v) - get<1>(u));
+    Vec2 w = {v.x - u.x, v.y - u.y};
 
-    return make_pair(get<0>(w) - get<0>(u), get<1>(w) - get<1>(u));
+    return {w.x - u.x, w.y - u.y};
 }
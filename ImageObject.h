@@ -2,10 +2,44 @@
 #define IMAGEOBJECT_H
 
 #include <utility>
-#include <vector>
+#include "Vec2.h"
 
 namespace deflection {
 
+/**
+ * Tags an ImageObject known to have an angle of 0, so that its sides are
+ * parallel to the x and y axes, such as a projectile, the player, the target
+ * or a cell of a grid. Used to choose a collision kernel at compile time.
+ */
+struct AxisAligned {
+};
+
+/**
+ * Tags an ImageObject that may be rotated by any angle, such as a wall. Used
+ * to choose a collision kernel at compile time.
+ */
+struct Oriented {
+};
+
+/**
+ * The contact between two overlapping ImageObjects, found along the axis of
+ * the separating axis theorem on which they overlap the least.
+ */
+struct Contact {
+
+    /** Whether the objects overlap at all. */
+    bool hit;
+
+    /**
+     * The unit normal of the contact, pointing from the other object towards
+     * this one, along which this one must move to stop overlapping.
+     */
+    Vec2 normal;
+
+    /** How far the objects overlap along the normal. */
+    double depth;
+};
+
 /**
  * Represents an object with an index for its image, a position in x and y
  * coordinates, a width, a length, and an angle.
@@ -40,6 +74,27 @@ public:
      */
     int getTopLeftYCoordinate() const noexcept;
 
+    /**
+     * The x coordinate of the center of this ImageObject.
+     * @return a double representing the center x coordinate.
+     */
+    double getCenterX() const noexcept;
+
+    /**
+     * The y coordinate of the center of this ImageObject.
+     * @return a double representing the center y coordinate.
+     */
+    double getCenterY() const noexcept;
+
+    /**
+     * Moves the center of this ImageObject to the given coordinates, and marks
+     * its cached geometry as out of date. Derived classes that move must use
+     * this instead of assigning cx_ and cy_ directly.
+     * @param x is a double representing the new x coordinate.
+     * @param y is a double representing the new y coordinate.
+     */
+    void setCenter(double x, double y) noexcept;
+
     /**
      * Returns the width of this ImageObject.
      * @return an int representing width of this ImageObject.
@@ -65,12 +120,20 @@ public:
     double getAngle() const noexcept;
 
     /**
-     * Returns a vector of pairs of doubles, with the first representing the x coordinate
-     * and the second representing the y coordinate, representing the vertices of this
-     * ImageObject.
+     * Returns the vertices of this ImageObject, in order around its sides,
+     * starting with the top left corner before rotation. The vertices are
+     * cached, and are only recomputed after this ImageObject has moved.
      * @return the vertices of this ImageObject.
      */
-    std::vector<std::pair<double, double> > getVertices() const noexcept;
+    const Quad& getVertices() const noexcept;
+
+    /**
+     * Returns the normals of the sides of this ImageObject, in the same order
+     * as the sides formed by its vertices. The normals are cached along with
+     * the vertices.
+     * @return the axes of this ImageObject.
+     */
+    const Quad& getNormals() const noexcept;
 
     /**
      * Determines whether this ImageObject collides with the given ImageObject,
@@ -81,67 +144,102 @@ public:
     bool hits(const ImageObject& other) const noexcept;
 
     /**
-     * Returns a pair of doubles, with the first representing the x vector, and
-     * the second representing the y vector, which represents the vector that
-     * this ImageObject should travel after hitting the given ImageObject other.
-     * The given ImageObject is treated as static, and this ImageObject is assumed
-     * to be traveling along the given vector vx and vy.
+     * Determines whether this ImageObject collides with the given ImageObject,
+     * using a kernel chosen at compile time for the shapes of the two. Two
+     * AxisAligned objects only compare the distance between their centers
+     * with their half sizes, and an AxisAligned object against an Oriented one
+     * tests the four axes with unit vectors and no projection of vertices.
+     * Two Oriented objects use the generic hits, which is the reference the
+     * other kernels agree with, and which is used when a shape is unknown.
+     * @tparam Shape is AxisAligned or Oriented, the shape of this ImageObject.
+     * @tparam OtherShape is AxisAligned or Oriented, the shape of the other.
+     * @param other is the ImageObject to check for collision.
+     * @return true if the other ImageObject is colliding with this one, false otherwise.
+     */
+    template <typename Shape, typename OtherShape>
+    bool hits(const ImageObject& other) const noexcept {
+        return hits(other);
+    }
+
+    /**
+     * Finds the contact between this ImageObject and the given ImageObject in
+     * a single pass of the separating axis theorem, keeping the axis with the
+     * least overlap as the normal and the overlap as the depth.
+     * @param other is the ImageObject to find the contact with.
+     * @return the Contact, whose normal and depth are only set if it hit.
+     */
+    Contact contact(const ImageObject& other) const noexcept;
+
+    /**
+     * Finds the contact between this ImageObject and the given ImageObject
+     * with a kernel chosen at compile time for their shapes, in the same way
+     * as the hits template. Two AxisAligned objects compare the distance
+     * between their centers with their half sizes, and an AxisAligned object
+     * against an Oriented one uses the four unit axes. Nothing bounces off an
+     * object it is not AxisAligned against, so the other pairs are left to the
+     * generic contact.
+     * @tparam Shape is AxisAligned or Oriented, the shape of this ImageObject.
+     * @tparam OtherShape is AxisAligned or Oriented, the shape of the other.
+     * @param other is the ImageObject to find the contact with.
+     * @return the Contact, whose normal and depth are only set if it hit.
+     */
+    template <typename Shape, typename OtherShape>
+    Contact contact(const ImageObject& other) const noexcept {
+        return contact(other);
+    }
+
+    /**
+     * Returns the vector that this ImageObject should travel after hitting the
+     * given ImageObject other. The given ImageObject is treated as static, and
+     * this ImageObject is assumed to be traveling along the given vector vx and vy.
      * @param other is the ImageObject to bounce this ImageObject off of.
      * @param vx is the x vector that this ImageObject is assumed to be traveling
      * at.
      * @param vy is the y vector that this ImageObject is assumed to be traveling
      * at.
-     * @return a pair of doubles.
+     * @return a Vec2 representing the new vector.
      */
-    std::pair<double, double> bounce(const ImageObject& other, double vx, double vy) const noexcept;
+    Vec2 bounce(const ImageObject& other, double vx, double vy) const noexcept;
 
     /**
      * A static method on ImageObjects which computes the dot product of the given
-     * points. The first in the pairs represents the x value, and the second
-     * represents the y value.
-     * @param one is the first point.
-     * @param two is the second point.
+     * vectors.
+     * @param one is the first vector.
+     * @param two is the second vector.
      * @return a double representing the result of the dot product of the two
-     * given points.
+     * given vectors.
      */
-    static double dotProduct(std::pair<double, double> one, std::pair<double, double> two) noexcept;
+    static double dotProduct(Vec2 one, Vec2 two) noexcept;
 
     /**
      * A static method which returns a pair of doubles which represents the min and max after projecting
-     * the given vector of points across the given axis. The first represents
-     * the min, and the second represents the max.
-     * @param points is the vector of pairs of doubles which should be projected
-     * across the axis. The first in the pairs represents the x value, and the
-     * second represents the y value.
-     * @param axis is the pair of doubles representing the axis that the points
-     * should be projected across.
+     * the given points across the given axis. The first represents the min,
+     * and the second represents the max.
+     * @param points is the Quad of points which should be projected across
+     * the axis.
+     * @param axis is the Vec2 representing the axis that the points should be
+     * projected across.
      * @return a pair of doubles.
      */
-    static std::pair<double, double> project(
-            std::vector<std::pair<double, double> > points, std::pair<double, double> axis) noexcept;
+    static std::pair<double, double> project(const Quad& points, Vec2 axis) noexcept;
 
     /**
-     * A static method which returns the axes of the given vector of points. Axes are retrieved by
-     * taking the normals of each side, and sides are defined by two adjacent points
-     * in the given vector.
-     * @param points1 is the vector of pairs of doubles representing points to
-     * get the axes of.
-     * @return a vector of pairs of doubles representing the axes of the given
-     * vector of points.
+     * A static method which returns the axes of the given points. Axes are retrieved by
+     * taking the normals of each side, and sides are defined by two adjacent points.
+     * @param points1 is the Quad of points to get the axes of.
+     * @return a Quad of the axes of the given points.
      */
-    static std::vector<std::pair<double, double> > getAxes(
-            std::vector<std::pair<double, double> > points1) noexcept;
+    static Quad getAxes(const Quad& points1) noexcept;
 
     /**
      * A static method which returns the smallest distance between the given
      * point and the line defined by the two given line points.
-     * @param point is a pair of doubles representing x and y values.
-     * @param linePoint1 is a pair of doubles representing the first point of the line.
-     * @param linePoint2 is a pair of doubles representing the second point of the line.
+     * @param point is a Vec2 representing x and y values.
+     * @param linePoint1 is a Vec2 representing the first point of the line.
+     * @param linePoint2 is a Vec2 representing the second point of the line.
      * @return a double representing the smallest distance.
      */
-    static double lineDistance(std::pair<double, double> point,
-            std::pair<double, double> linePoint1, std::pair<double, double> linePoint2) noexcept;
+    static double lineDistance(Vec2 point, Vec2 linePoint1, Vec2 linePoint2) noexcept;
 
 protected:
 
@@ -162,7 +260,86 @@ protected:
 
     /** The angle, in degrees, of this ImageObject. */
     double angle_ = 0.0;
+
+private:
+
+    /**
+     * Recomputes the cached vertices and extents of this ImageObject by
+     * shifting the ones around its center to its current center.
+     */
+    void updateGeometry() const noexcept;
+
+    /**
+     * Recomputes the cached geometry if this ImageObject has moved since it
+     * was last computed. Objects that never move, such as walls, are computed
+     * once on construction, so they are never updated by this and may be
+     * shared between threads.
+     */
+    void refreshGeometry() const noexcept;
+
+    /** The cosine of the angle of this ImageObject. */
+    double cos_ = 1.0;
+
+    /** The sine of the angle of this ImageObject. */
+    double sin_ = 0.0;
+
+    /** The vertices of this ImageObject relative to its center. */
+    Quad offsets_;
+
+    /**
+     * The normals of the sides of this ImageObject, which only depend on its
+     * size and rotation.
+     */
+    Quad normals_;
+
+    /**
+     * The min and max of the vertices relative to the center projected across
+     * the first two normals. The other two normals are the opposites of these,
+     * so they separate exactly the same objects and are never tested.
+     */
+    std::pair<double, double> offsetExtents_[2];
+
+    /** Whether the cached vertices and extents are out of date. */
+    mutable bool dirty_ = true;
+
+    /** The cached vertices of this ImageObject. */
+    mutable Quad vertices_;
+
+    /**
+     * The cached min and max of the vertices of this ImageObject projected
+     * across its first two normals.
+     */
+    mutable std::pair<double, double> extents_[2];
 };
+
+/** Two axis-aligned boxes overlap when they overlap along both axes. */
+template <>
+bool ImageObject::hits<AxisAligned, AxisAligned>(const ImageObject& other) const noexcept;
+
+/**
+ * An axis-aligned box and a rotated one overlap when they overlap along the x
+ * and y axes and the two axes of the rotated one.
+ */
+template <>
+bool ImageObject::hits<AxisAligned, Oriented>(const ImageObject& other) const noexcept;
+
+/** The same as the other way around. */
+template <>
+bool ImageObject::hits<Oriented, AxisAligned>(const ImageObject& other) const noexcept;
+
+/**
+ * The contact of two axis-aligned boxes, along whichever of the x and y axes
+ * they overlap least.
+ */
+template <>
+Contact ImageObject::contact<AxisAligned, AxisAligned>(const ImageObject& other) const noexcept;
+
+/**
+ * The contact of an axis-aligned box with a rotated one, along whichever of
+ * the x and y axes and the two axes of the rotated one they overlap least.
+ */
+template <>
+Contact ImageObject::contact<AxisAligned, Oriented>(const ImageObject& other) const noexcept;
 }
 
 
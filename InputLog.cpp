@@ -0,0 +1,50 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "InputLog.h"
+
+using namespace std;
+using namespace deflection;
+
+InputLog::InputLog(const string& fileLocation) {
+    ifstream in(fileLocation, ios::binary);
+    if (!in) {
+        throw domain_error("Unable to open the input log at " + fileLocation);
+    }
+    if (!in.read(reinterpret_cast<char*>(&header_), sizeof(header_))
+            || memcmp(header_.magic, "DFLI", 4) != 0 || header_.version != INPUT_LOG_VERSION
+            || header_.tickRate <= 0.0) {
+        throw domain_error("The file at " + fileLocation + " is not a valid input log");
+    }
+
+    // Read the inputs in one go, dropping a partly written last input
+    in.seekg(0, ios::end);
+    size_t bytes = (size_t) in.tellg() - sizeof(header_);
+    inputs_.resize(bytes / sizeof(InputRecord));
+    in.seekg(sizeof(header_));
+    if (!in.read(reinterpret_cast<char*>(inputs_.data()), inputs_.size() * sizeof(InputRecord))) {
+        throw domain_error("Unable to read the input log at " + fileLocation);
+    }
+
+    // Inputs are replayed as their ticks come up, so one out of order would
+    // never be reached and every input after it would be dropped
+    for (size_t i = 1; i < inputs_.size(); i += 1) {
+        if (inputs_[i].tick < inputs_[i - 1].tick) {
+            throw domain_error("The input log at " + fileLocation + " has input "
+                    + to_string(i) + " out of order, at tick " + to_string(inputs_[i].tick)
+                    + " after tick " + to_string(inputs_[i - 1].tick));
+        }
+    }
+}
+
+const InputLogHeader& InputLog::getHeader() const noexcept {
+    return header_;
+}
+
+const vector<InputRecord>& InputLog::getInputs() const noexcept {
+    return inputs_;
+}
+
+uint32_t InputLog::getNumTicks() const noexcept {
+    return inputs_.empty() ? 0 : inputs_.back().tick;
+}
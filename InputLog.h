@@ -0,0 +1,161 @@
+#ifndef INPUTLOG_H
+#define INPUTLOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Input logs are read straight into these structs, so the host must use the
+// byte order of the file
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Input logs are read in place and need a little endian host"
+#endif
+
+namespace deflection {
+
+/**
+ * The header at the start of an input log file. Like a level corpus, an input
+ * log is stored little endian in exactly the layout of these structs, which is
+ * checked below.
+ */
+struct InputLogHeader {
+
+    /** The characters "DFLI", identifying an input log. */
+    char magic[4];
+
+    /** The version of the format, INPUT_LOG_VERSION. */
+    std::uint32_t version;
+
+    /** The seed of the random number generator of the ActiveGame. */
+    std::uint32_t seed;
+
+    /** The number of walls of the ActiveGame. */
+    std::uint32_t numWalls;
+
+    /** The width of the screen. */
+    std::uint32_t screenWidth;
+
+    /** The height of the screen. */
+    std::uint32_t screenHeight;
+
+    /** INPUT_LOG_WINNABLE and INPUT_LOG_CORPUS, or 0. */
+    std::uint32_t flags;
+
+    /** Unused, always 0. */
+    std::uint32_t reserved;
+
+    /** The number of ticks simulated per second. */
+    double tickRate;
+};
+
+static_assert(sizeof(InputLogHeader) == 40, "InputLogHeader must match the file format");
+static_assert(offsetof(InputLogHeader, version) == 4, "InputLogHeader must match the file format");
+static_assert(offsetof(InputLogHeader, seed) == 8, "InputLogHeader must match the file format");
+static_assert(offsetof(InputLogHeader, numWalls) == 12, "InputLogHeader must match the file format");
+static_assert(offsetof(InputLogHeader, screenWidth) == 16, "InputLogHeader must match the file format");
+static_assert(offsetof(InputLogHeader, screenHeight) == 20, "InputLogHeader must match the file format");
+static_assert(offsetof(InputLogHeader, flags) == 24, "InputLogHeader must match the file format");
+static_assert(offsetof(InputLogHeader, reserved) == 28, "InputLogHeader must match the file format");
+static_assert(offsetof(InputLogHeader, tickRate) == 32, "InputLogHeader must match the file format");
+
+/**
+ * An input in an input log.
+ */
+struct InputRecord {
+
+    /**
+     * The number of ticks simulated before the input was applied. Inputs are
+     * applied before the tick with this number, so the ticks of the inputs of
+     * a log never decrease.
+     */
+    std::uint32_t tick;
+
+    /** INPUT_FIRE, INPUT_RESTART or INPUT_END. */
+    std::uint16_t type;
+
+    /** Unused, always 0. */
+    std::uint16_t reserved;
+
+    /** The x coordinate fired towards, for INPUT_FIRE. */
+    std::int32_t x;
+
+    /** The y coordinate fired towards, for INPUT_FIRE. */
+    std::int32_t y;
+};
+
+static_assert(sizeof(InputRecord) == 16, "InputRecord must match the file format");
+static_assert(offsetof(InputRecord, type) == 4, "InputRecord must match the file format");
+static_assert(offsetof(InputRecord, reserved) == 6, "InputRecord must match the file format");
+static_assert(offsetof(InputRecord, x) == 8, "InputRecord must match the file format");
+static_assert(offsetof(InputRecord, y) == 12, "InputRecord must match the file format");
+
+/** The current version of the input log format. */
+constexpr std::uint32_t INPUT_LOG_VERSION = 1;
+
+/** The flag for sessions that only played winnable levels. */
+constexpr std::uint32_t INPUT_LOG_WINNABLE = 1;
+
+/**
+ * The flag for sessions that played the levels of a level corpus, which must
+ * be given again to replay them.
+ */
+constexpr std::uint32_t INPUT_LOG_CORPUS = 2;
+
+/** The type of an input where the player fired. */
+constexpr std::uint16_t INPUT_FIRE = 0;
+
+/** The type of an input where the player asked for a new level. */
+constexpr std::uint16_t INPUT_RESTART = 1;
+
+/** The type of the input marking the end of the session. */
+constexpr std::uint16_t INPUT_END = 2;
+
+/**
+ * An input log read from a file written by an InputLogWriter, holding the
+ * header and the inputs of a recorded session in order.
+ *
+ * @author Trevor Day
+ */
+class InputLog {
+public:
+
+    /**
+     * Reads the input log at the given location. A log cut short, such as by
+     * the game crashing, is read up to its last whole input.
+     * @param fileLocation is the location of the file.
+     * @throw domain_error if the file could not be read, is not an input
+     * log, or has inputs whose ticks are out of order.
+     */
+    explicit InputLog(const std::string& fileLocation);
+
+    /**
+     * Returns the header of this log.
+     * @return the InputLogHeader.
+     */
+    const InputLogHeader& getHeader() const noexcept;
+
+    /**
+     * Returns the inputs of this log, in the order they were recorded.
+     * @return a const reference to the vector of InputRecords.
+     */
+    const std::vector<InputRecord>& getInputs() const noexcept;
+
+    /**
+     * Returns the number of ticks in the recorded session, which is the tick
+     * of its last input.
+     * @return the number of ticks.
+     */
+    std::uint32_t getNumTicks() const noexcept;
+
+private:
+
+    /** The header of the log. */
+    InputLogHeader header_;
+
+    /** The inputs of the log. */
+    std::vector<InputRecord> inputs_;
+};
+}
+
+#endif /* INPUTLOG_H */
@@ -0,0 +1,26 @@
+#include <cstring>
+#include <stdexcept>
+#include "InputLogWriter.h"
+
+using namespace std;
+using namespace deflection;
+
+InputLogWriter::InputLogWriter(const string& fileLocation, InputLogHeader header)
+: out_(fileLocation, ios::binary | ios::trunc) {
+    if (!out_) {
+        throw domain_error("Unable to create the input log at " + fileLocation);
+    }
+    memcpy(header.magic, "DFLI", 4);
+    header.version = INPUT_LOG_VERSION;
+    header.reserved = 0;
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void InputLogWriter::record(uint32_t tick, uint16_t type, int x, int y) noexcept {
+    InputRecord input = {tick, type, 0, x, y};
+    out_.write(reinterpret_cast<const char*>(&input), sizeof(input));
+}
+
+void InputLogWriter::flush() noexcept {
+    out_.flush();
+}
@@ -0,0 +1,51 @@
+#ifndef INPUTLOGWRITER_H
+#define INPUTLOGWRITER_H
+
+#include <fstream>
+#include <string>
+#include "InputLog.h"
+
+namespace deflection {
+
+/**
+ * Records the inputs of a session to an append only input log, to be replayed
+ * with an InputLog. Each input is appended as it happens, so a log is usable
+ * up to the last flush even if the session ends abruptly.
+ *
+ * @author Trevor Day
+ */
+class InputLogWriter {
+public:
+
+    /**
+     * Creates an input log at the given location, replacing any file there,
+     * and writes its header.
+     * @param fileLocation is the location of the file.
+     * @param header is the header of the log, whose magic and version are
+     * filled in by this.
+     * @throw domain_error if the file could not be created.
+     */
+    InputLogWriter(const std::string& fileLocation, InputLogHeader header);
+
+    /**
+     * Appends an input to the log.
+     * @param tick is the number of ticks simulated before the input.
+     * @param type is INPUT_FIRE, INPUT_RESTART or INPUT_END.
+     * @param x is the x coordinate fired towards, for INPUT_FIRE.
+     * @param y is the y coordinate fired towards, for INPUT_FIRE.
+     */
+    void record(std::uint32_t tick, std::uint16_t type, int x = 0, int y = 0) noexcept;
+
+    /**
+     * Writes the inputs appended so far to the file.
+     */
+    void flush() noexcept;
+
+private:
+
+    /** The file being written. */
+    std::ofstream out_;
+};
+}
+
+#endif /* INPUTLOGWRITER_H */
@@ -0,0 +1,24 @@
+#include "InputQueue.h"
+
+using namespace std;
+using namespace deflection;
+
+bool InputQueue::push(const InputEvent& event) noexcept {
+    unsigned int tail = tail_.load(memory_order_relaxed);
+    if (tail - head_.load(memory_order_acquire) == CAPACITY) {
+        return false;
+    }
+    events_[tail % CAPACITY] = event;
+    tail_.store(tail + 1, memory_order_release);
+    return true;
+}
+
+bool InputQueue::pop(InputEvent& event) noexcept {
+    unsigned int head = head_.load(memory_order_relaxed);
+    if (head == tail_.load(memory_order_acquire)) {
+        return false;
+    }
+    event = events_[head % CAPACITY];
+    head_.store(head + 1, memory_order_release);
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef INPUTQUEUE_H
+#define INPUTQUEUE_H
+
+#include <array>
+#include <atomic>
+#include "EventQueue.h"
+
+namespace deflection {
+
+/**
+ * A lock free ring of InputEvents with a fixed capacity, passing input from
+ * one thread to one other thread. The render thread pushes the input it polls
+ * and the simulation thread pops it before each tick, and neither ever
+ * waits for the other.
+ *
+ * @author Trevor Day
+ */
+class InputQueue {
+public:
+
+    /** The most events the queue holds, a power of two. */
+    static constexpr unsigned int CAPACITY = 256;
+
+    /**
+     * Adds an event to the end of the queue, if it is not full. Only the
+     * producing thread may call this.
+     * @param event is the InputEvent to add.
+     * @return true if the event was added, false if the queue was full.
+     */
+    bool push(const InputEvent& event) noexcept;
+
+    /**
+     * Removes the event at the front of the queue, if there is one. Only the
+     * consuming thread may call this.
+     * @param event is set to the event removed.
+     * @return true if an event was removed, false if the queue was empty.
+     */
+    bool pop(InputEvent& event) noexcept;
+
+private:
+
+    /** The events, indexed by their position modulo CAPACITY. */
+    std::array<InputEvent, CAPACITY> events_;
+
+    /** The position of the next event to pop, written by the consumer. */
+    alignas(64) std::atomic<unsigned int> head_{0};
+
+    /** The position of the next event to push, written by the producer. */
+    alignas(64) std::atomic<unsigned int> tail_{0};
+};
+}
+
+#endif /* INPUTQUEUE_H */
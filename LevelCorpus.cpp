@@ -0,0 +1,72 @@
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "LevelCorpus.h"
+
+using namespace std;
+using namespace deflection;
+
+LevelCorpus::LevelCorpus(const string& fileLocation) {
+
+    // Map the whole file. The mapping stays valid after the file is closed.
+    int fd = open(fileLocation.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw domain_error("Unable to open the level corpus at " + fileLocation);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(CorpusHeader)) {
+        close(fd);
+        throw domain_error("The level corpus at " + fileLocation + " is too small");
+    }
+    size_ = info.st_size;
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw domain_error("Unable to map the level corpus at " + fileLocation);
+    }
+    data_ = static_cast<const unsigned char*>(mapping);
+
+    // Check that the header describes this file before trusting any of it.
+    // The records must fit in the bytes after their offset, which is checked
+    // by division so that a huge offset or count cannot wrap around.
+    header_ = reinterpret_cast<const CorpusHeader*>(data_);
+    if (memcmp(header_->magic, "DFLC", 4) != 0 || header_->version != CORPUS_VERSION
+            || header_->levelsOffset > size_
+            || header_->levelCount > (size_ - header_->levelsOffset) / sizeof(CorpusLevel)
+            || header_->wallsOffset > size_
+            || header_->wallCount > (size_ - header_->wallsOffset) / sizeof(CorpusWall)
+            || header_->levelsOffset % alignof(CorpusLevel) != 0
+            || header_->wallsOffset % alignof(CorpusWall) != 0) {
+        munmap(mapping, size_);
+        throw domain_error("The file at " + fileLocation + " is not a valid level corpus");
+    }
+    levels_ = reinterpret_cast<const CorpusLevel*>(data_ + header_->levelsOffset);
+    walls_ = reinterpret_cast<const CorpusWall*>(data_ + header_->wallsOffset);
+}
+
+LevelCorpus::~LevelCorpus() {
+    munmap(const_cast<unsigned char*>(data_), size_);
+}
+
+unsigned int LevelCorpus::size() const noexcept {
+    return header_->levelCount;
+}
+
+const CorpusHeader& LevelCorpus::getHeader() const noexcept {
+    return *header_;
+}
+
+const CorpusLevel& LevelCorpus::getLevel(unsigned int i) const noexcept {
+    return levels_[i];
+}
+
+bool LevelCorpus::isValid(const CorpusLevel& level) const noexcept {
+    return (uint64_t) level.firstWall + level.numWalls <= header_->wallCount;
+}
+
+const CorpusWall* LevelCorpus::getWalls(const CorpusLevel& level) const noexcept {
+    return walls_ + level.firstWall;
+}
@@ -0,0 +1,221 @@
+#ifndef LEVELCORPUS_H
+#define LEVELCORPUS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A corpus is read in place, so the host must use the byte order of the file
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Level corpora are read in place and need a little endian host"
+#endif
+
+namespace deflection {
+
+/**
+ * The header at the start of a level corpus file. All values in a corpus are
+ * stored little endian, in exactly the layout of these structs, so a corpus is
+ * used straight from memory without parsing. The layouts are checked below, so
+ * a compiler that pads them differently fails to build instead of misreading
+ * a corpus, and a file of the other byte order fails the version check.
+ */
+struct CorpusHeader {
+
+    /** The characters "DFLC", identifying a level corpus. */
+    char magic[4];
+
+    /** The version of the format, CORPUS_VERSION. */
+    std::uint32_t version;
+
+    /** The number of levels in the corpus. */
+    std::uint32_t levelCount;
+
+    /** The total number of walls in the corpus. */
+    std::uint32_t wallCount;
+
+    /** The width of the screen the levels were generated for. */
+    std::uint32_t screenWidth;
+
+    /** The height of the screen the levels were generated for. */
+    std::uint32_t screenHeight;
+
+    /** The offset in bytes of the first CorpusWall in the file. */
+    std::uint64_t wallsOffset;
+
+    /** The offset in bytes of the index of CorpusLevels in the file. */
+    std::uint64_t levelsOffset;
+};
+
+static_assert(sizeof(CorpusHeader) == 40, "CorpusHeader must match the file format");
+static_assert(offsetof(CorpusHeader, version) == 4, "CorpusHeader must match the file format");
+static_assert(offsetof(CorpusHeader, levelCount) == 8, "CorpusHeader must match the file format");
+static_assert(offsetof(CorpusHeader, wallCount) == 12, "CorpusHeader must match the file format");
+static_assert(offsetof(CorpusHeader, screenWidth) == 16, "CorpusHeader must match the file format");
+static_assert(offsetof(CorpusHeader, screenHeight) == 20, "CorpusHeader must match the file format");
+static_assert(offsetof(CorpusHeader, wallsOffset) == 24, "CorpusHeader must match the file format");
+static_assert(offsetof(CorpusHeader, levelsOffset) == 32, "CorpusHeader must match the file format");
+
+/**
+ * A wall of a level in a corpus.
+ */
+struct CorpusWall {
+
+    /** The x coordinate of the center of the wall. */
+    std::int32_t x;
+
+    /** The y coordinate of the center of the wall. */
+    std::int32_t y;
+
+    /** The width of the wall. */
+    std::uint16_t width;
+
+    /** The length of the wall. */
+    std::uint16_t length;
+
+    /** The angle of the wall in degrees. */
+    std::int16_t angle;
+
+    /** Unused, always 0. */
+    std::uint16_t reserved;
+};
+
+static_assert(sizeof(CorpusWall) == 16, "CorpusWall must match the file format");
+static_assert(offsetof(CorpusWall, y) == 4, "CorpusWall must match the file format");
+static_assert(offsetof(CorpusWall, width) == 8, "CorpusWall must match the file format");
+static_assert(offsetof(CorpusWall, length) == 10, "CorpusWall must match the file format");
+static_assert(offsetof(CorpusWall, angle) == 12, "CorpusWall must match the file format");
+static_assert(offsetof(CorpusWall, reserved) == 14, "CorpusWall must match the file format");
+
+/**
+ * A level in a corpus, which is also its entry in the index. Its walls are
+ * stored one after another, starting at firstWall.
+ */
+struct CorpusLevel {
+
+    /** The x coordinate of the center of the player. */
+    std::int32_t playerX;
+
+    /** The y coordinate of the center of the player. */
+    std::int32_t playerY;
+
+    /** The x coordinate of the center of the target. */
+    std::int32_t targetX;
+
+    /** The y coordinate of the center of the target. */
+    std::int32_t targetY;
+
+    /** The length of the sides of the player. */
+    std::uint16_t playerSize;
+
+    /** The width of the target. */
+    std::uint16_t targetWidth;
+
+    /** The length of the target. */
+    std::uint16_t targetLength;
+
+    /** Unused, always 0. */
+    std::uint16_t reserved;
+
+    /** The index of the first wall of the level among all the walls. */
+    std::uint32_t firstWall;
+
+    /** The number of walls of the level. */
+    std::uint32_t numWalls;
+};
+
+static_assert(sizeof(CorpusLevel) == 32, "CorpusLevel must match the file format");
+static_assert(offsetof(CorpusLevel, playerY) == 4, "CorpusLevel must match the file format");
+static_assert(offsetof(CorpusLevel, targetX) == 8, "CorpusLevel must match the file format");
+static_assert(offsetof(CorpusLevel, targetY) == 12, "CorpusLevel must match the file format");
+static_assert(offsetof(CorpusLevel, playerSize) == 16, "CorpusLevel must match the file format");
+static_assert(offsetof(CorpusLevel, targetWidth) == 18, "CorpusLevel must match the file format");
+static_assert(offsetof(CorpusLevel, targetLength) == 20, "CorpusLevel must match the file format");
+static_assert(offsetof(CorpusLevel, reserved) == 22, "CorpusLevel must match the file format");
+static_assert(offsetof(CorpusLevel, firstWall) == 24, "CorpusLevel must match the file format");
+static_assert(offsetof(CorpusLevel, numWalls) == 28, "CorpusLevel must match the file format");
+
+/** The current version of the level corpus format. */
+constexpr std::uint32_t CORPUS_VERSION = 1;
+
+/**
+ * A read only level corpus, memory mapped from a file written by a
+ * LevelCorpusWriter. Levels and walls are read in place from the mapping, so
+ * opening a corpus of any size costs the same, and nothing is copied.
+ *
+ * @author Trevor Day
+ */
+class LevelCorpus {
+public:
+
+    /**
+     * Opens and maps the corpus at the given location.
+     * @param fileLocation is the location of the file.
+     * @throw domain_error if the file could not be opened or mapped, or is not
+     * a valid corpus.
+     */
+    explicit LevelCorpus(const std::string& fileLocation);
+
+    /**
+     * Destruct the corpus, unmapping the file.
+     */
+    ~LevelCorpus();
+
+    LevelCorpus(const LevelCorpus&) = delete;
+    LevelCorpus& operator=(const LevelCorpus&) = delete;
+
+    /**
+     * Returns the number of levels in this corpus.
+     * @return an unsigned int representing the number of levels.
+     */
+    unsigned int size() const noexcept;
+
+    /**
+     * Returns the header of this corpus.
+     * @return the CorpusHeader.
+     */
+    const CorpusHeader& getHeader() const noexcept;
+
+    /**
+     * Returns the level at the given index.
+     * @param i is the index of the level, less than size().
+     * @return the CorpusLevel.
+     */
+    const CorpusLevel& getLevel(unsigned int i) const noexcept;
+
+    /**
+     * Returns whether the walls of the given level are within this corpus.
+     * Levels are not all checked when the corpus is opened, so that opening
+     * does not read the whole index, and are checked by this as they are used
+     * instead.
+     * @param level is a CorpusLevel of this corpus.
+     * @return true if the walls of the level are within this corpus.
+     */
+    bool isValid(const CorpusLevel& level) const noexcept;
+
+    /**
+     * Returns the walls of the given level, which must be valid.
+     * @param level is a CorpusLevel of this corpus.
+     * @return a pointer to the first of the level's numWalls walls.
+     */
+    const CorpusWall* getWalls(const CorpusLevel& level) const noexcept;
+
+private:
+
+    /** The start of the mapping. */
+    const unsigned char* data_ = nullptr;
+
+    /** The size of the mapping in bytes. */
+    std::size_t size_ = 0;
+
+    /** The header, at the start of the mapping. */
+    const CorpusHeader* header_ = nullptr;
+
+    /** The index of levels, within the mapping. */
+    const CorpusLevel* levels_ = nullptr;
+
+    /** The walls of all the levels, within the mapping. */
+    const CorpusWall* walls_ = nullptr;
+};
+}
+
+#endif /* LEVELCORPUS_H */
@@ -0,0 +1,85 @@
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "LevelCorpusWriter.h"
+
+using namespace std;
+using namespace deflection;
+
+LevelCorpusWriter::LevelCorpusWriter(const string& fileLocation, unsigned int screenWidth,
+        unsigned int screenHeight)
+: fileLocation_(fileLocation), out_(fileLocation, ios::binary | ios::trunc) {
+    if (!out_) {
+        throw domain_error("Unable to create the level corpus at " + fileLocation);
+    }
+    memset(&header_, 0, sizeof(header_));
+    memcpy(header_.magic, "DFLC", 4);
+    header_.version = CORPUS_VERSION;
+    header_.screenWidth = screenWidth;
+    header_.screenHeight = screenHeight;
+    header_.wallsOffset = sizeof(CorpusHeader);
+
+    // The header is written again with its counts when closing
+    out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+}
+
+LevelCorpusWriter::~LevelCorpusWriter() {
+    try {
+        close();
+    } catch (const exception&) {
+        // A destructor cannot report the failure
+    }
+}
+
+void LevelCorpusWriter::add(const Player& player, const ImageObject& target,
+        const vector<ImageObject>& walls) {
+    CorpusLevel level;
+    memset(&level, 0, sizeof(level));
+    level.playerX = lround(player.getCenterX());
+    level.playerY = lround(player.getCenterY());
+    level.playerSize = player.getWidth();
+    level.targetX = lround(target.getCenterX());
+    level.targetY = lround(target.getCenterY());
+    level.targetWidth = target.getWidth();
+    level.targetLength = target.getLength();
+    level.firstWall = header_.wallCount;
+    level.numWalls = walls.size();
+    levels_.push_back(level);
+
+    for (const ImageObject& w : walls) {
+        CorpusWall wall;
+        memset(&wall, 0, sizeof(wall));
+        wall.x = lround(w.getCenterX());
+        wall.y = lround(w.getCenterY());
+        wall.width = w.getWidth();
+        wall.length = w.getLength();
+        wall.angle = lround(w.getAngle());
+        out_.write(reinterpret_cast<const char*>(&wall), sizeof(wall));
+    }
+    header_.wallCount += walls.size();
+    header_.levelCount += 1;
+    if (!out_) {
+        throw domain_error("Unable to write to the level corpus at " + fileLocation_);
+    }
+}
+
+void LevelCorpusWriter::close() {
+    if (!out_.is_open()) {
+        return;
+    }
+
+    // The index follows the walls, and the header is rewritten with the
+    // final counts and the offset of the index
+    header_.levelsOffset = header_.wallsOffset + (uint64_t) header_.wallCount * sizeof(CorpusWall);
+    out_.write(reinterpret_cast<const char*>(levels_.data()), levels_.size() * sizeof(CorpusLevel));
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    out_.close();
+    if (!out_) {
+        throw domain_error("Unable to write to the level corpus at " + fileLocation_);
+    }
+}
+
+unsigned int LevelCorpusWriter::size() const noexcept {
+    return header_.levelCount;
+}
@@ -0,0 +1,78 @@
+#ifndef LEVELCORPUSWRITER_H
+#define LEVELCORPUSWRITER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "LevelCorpus.h"
+#include "Player.h"
+
+namespace deflection {
+
+/**
+ * Writes levels to a level corpus file, to be read by a LevelCorpus. Walls are
+ * written as levels are added, and the index of levels is written after them
+ * when the writer is closed, so the number of levels does not need to be
+ * known in advance.
+ *
+ * @author Trevor Day
+ */
+class LevelCorpusWriter {
+public:
+
+    /**
+     * Creates a corpus file at the given location, replacing any file there.
+     * @param fileLocation is the location of the file.
+     * @param screenWidth is the width of the screen the levels are for.
+     * @param screenHeight is the height of the screen the levels are for.
+     * @throw domain_error if the file could not be created.
+     */
+    LevelCorpusWriter(const std::string& fileLocation, unsigned int screenWidth,
+            unsigned int screenHeight);
+
+    /**
+     * Destruct the writer, closing it if it has not been closed.
+     */
+    ~LevelCorpusWriter();
+
+    /**
+     * Adds a level to the corpus. Positions and sizes are stored as whole
+     * pixels, and angles as whole degrees, as levels are generated with.
+     * @param player is the Player of the level.
+     * @param target is the target of the level.
+     * @param walls is the vector of walls of the level.
+     * @throw domain_error if the level could not be written.
+     */
+    void add(const Player& player, const ImageObject& target,
+            const std::vector<ImageObject>& walls);
+
+    /**
+     * Writes the index and the header and closes the file. Closing again does
+     * nothing.
+     * @throw domain_error if the file could not be written.
+     */
+    void close();
+
+    /**
+     * Returns the number of levels added so far.
+     * @return an unsigned int representing the number of levels.
+     */
+    unsigned int size() const noexcept;
+
+private:
+
+    /** The location of the file. */
+    const std::string fileLocation_;
+
+    /** The file being written. */
+    std::ofstream out_;
+
+    /** The header, completed when closing. */
+    CorpusHeader header_;
+
+    /** The index of levels, written when closing. */
+    std::vector<CorpusLevel> levels_;
+};
+}
+
+#endif /* LEVELCORPUSWRITER_H */
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cmath>
+#include "LevelGenerator.h"
+
+using namespace std;
+using namespace deflection;
+
+LevelGenerator::LevelGenerator(unsigned int screenWidth, unsigned int screenHeight,
+        unsigned int playerImageIndex, unsigned int targetImageIndex,
+        unsigned int wallImageIndex, unsigned int maxWallLength, unsigned int attemptsPerWall)
+: playerImageIndex_(playerImageIndex), targetImageIndex_(targetImageIndex),
+wallImageIndex_(wallImageIndex), attemptsPerWall_(attemptsPerWall),
+distrX_(0, screenWidth), distrY_(0, screenHeight),
+distrL_(0, maxWallLength != 0 ? maxWallLength : screenWidth), distrA_(0, 180),
+cellSize_(64.0) {
+    columns_ = max(1u, (unsigned int) ceil(screenWidth / cellSize_));
+    rows_ = max(1u, (unsigned int) ceil(screenHeight / cellSize_));
+}
+
+unsigned int LevelGenerator::column(double x) const noexcept {
+    double c = floor(x / cellSize_);
+    return c < 0 ? 0 : (c >= columns_ ? columns_ - 1 : (unsigned int) c);
+}
+
+unsigned int LevelGenerator::row(double y) const noexcept {
+    double r = floor(y / cellSize_);
+    return r < 0 ? 0 : (r >= rows_ ? rows_ - 1 : (unsigned int) r);
+}
+
+LevelGenerator::Bounds LevelGenerator::getBounds(const ImageObject& o) noexcept {
+    const Quad& vertices = o.getVertices();
+    Bounds b = {vertices[0].x, vertices[0].y, vertices[0].x, vertices[0].y};
+    for (const Vec2& v : vertices) {
+        b.minX = min(b.minX, v.x);
+        b.minY = min(b.minY, v.y);
+        b.maxX = max(b.maxX, v.x);
+        b.maxY = max(b.maxY, v.y);
+    }
+    return b;
+}
+
+void LevelGenerator::place(unsigned int object, const Bounds& bounds) {
+    bounds_.push_back(bounds);
+    lastCheck_.push_back(0);
+    unsigned int lastColumn = column(bounds.maxX);
+    unsigned int lastRow = row(bounds.maxY);
+    for (unsigned int r = row(bounds.minY); r <= lastRow; r += 1) {
+        for (unsigned int c = column(bounds.minX); c <= lastColumn; c += 1) {
+            int& head = cellHeads_[r * columns_ + c];
+            nodes_.push_back(make_pair(object, head));
+            head = nodes_.size() - 1;
+        }
+    }
+}
+
+bool LevelGenerator::overlaps(const ImageObject& candidate, const Bounds& bounds,
+        const Player& player, const ImageObject& target,
+        const vector<ImageObject>& walls) noexcept {
+    check_ += 1;
+    unsigned int lastColumn = column(bounds.maxX);
+    unsigned int lastRow = row(bounds.maxY);
+    for (unsigned int r = row(bounds.minY); r <= lastRow; r += 1) {
+        for (unsigned int c = column(bounds.minX); c <= lastColumn; c += 1) {
+            for (int n = cellHeads_[r * columns_ + c]; n != -1; n = get<1>(nodes_[n])) {
+                unsigned int object = get<0>(nodes_[n]);
+                if (lastCheck_[object] == check_) {
+                    continue;
+                }
+                lastCheck_[object] = check_;
+
+                // Only run the separating axis theorem if the bounding boxes
+                // overlap
+                const Bounds& other = bounds_[object];
+                if (bounds.maxX < other.minX || other.maxX < bounds.minX
+                        || bounds.maxY < other.minY || other.maxY < bounds.minY) {
+                    continue;
+                }
+                // The player and the target are never rotated
+                if (object < 2 ? candidate.hits<Oriented, AxisAligned>(object == 0 ? player : target)
+                        : candidate.hits<Oriented, Oriented>(walls[object - 2])) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+GenerationResult LevelGenerator::generate(mt19937& r, unsigned int numWalls,
+        Player& player, ImageObject& target, vector<ImageObject>& walls) {
+    GenerationResult result;
+
+    // Clear the grid, keeping its memory for the next level
+    cellHeads_.assign(columns_ * rows_, -1);
+    nodes_.clear();
+    bounds_.clear();
+    lastCheck_.clear();
+    check_ = 0;
+
+    // Randomly generate a player and a target
+    int playerX = distrX_(r);
+    int playerY = distrY_(r);
+    player = Player(playerImageIndex_, playerX, playerY, 30);
+    int targetX = distrX_(r);
+    int targetY = distrY_(r);
+    target = ImageObject(targetImageIndex_, targetX, targetY, 20, 20, 0);
+    place(0, getBounds(player));
+    place(1, getBounds(target));
+
+    // Randomly generate walls, only adding them if they don't collide with
+    // the player, the target, or another wall, until all are placed or the
+    // candidates run out
+    walls.clear();
+    walls.reserve(numWalls);
+    unsigned long long maxAttempts = (unsigned long long) numWalls * attemptsPerWall_;
+    while (walls.size() < numWalls && result.attempts < maxAttempts) {
+        result.attempts += 1;
+        int x = distrX_(r);
+        int y = distrY_(r);
+        int length = distrL_(r);
+        int angle = distrA_(r);
+        ImageObject w(wallImageIndex_, x, y, 10, length, angle);
+        Bounds b = getBounds(w);
+        if (!overlaps(w, b, player, target, walls)) {
+            place(walls.size() + 2, b);
+            walls.push_back(w);
+        }
+    }
+    result.wallsPlaced = walls.size();
+    result.complete = result.wallsPlaced == numWalls;
+    return result;
+}
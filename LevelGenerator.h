@@ -0,0 +1,184 @@
+#ifndef LEVELGENERATOR_H
+#define LEVELGENERATOR_H
+
+#include <random>
+#include <vector>
+#include "Player.h"
+
+namespace deflection {
+
+/**
+ * The result of generating a level with a LevelGenerator.
+ */
+struct GenerationResult {
+
+    /** Whether every requested wall was placed. */
+    bool complete = false;
+
+    /** The number of walls placed. */
+    unsigned int wallsPlaced = 0;
+
+    /** The number of candidate walls tried. */
+    unsigned int attempts = 0;
+};
+
+/**
+ * Generates levels with a randomly placed player, randomly placed target, and
+ * randomly placed and sized walls that do not overlap each other, the player,
+ * or the target. Placed objects are kept in a grid, so a candidate wall is
+ * only checked against the objects near it. Each wall gets a bounded number
+ * of candidates, so a crowded level ends with fewer walls, reported in the
+ * GenerationResult, instead of never ending.
+ *
+ * @author Trevor Day
+ */
+class LevelGenerator {
+public:
+
+    /**
+     * Constructs a new LevelGenerator with the given parameters.
+     * @param screenWidth is the width of the screen in pixels.
+     * @param screenHeight is the height of the screen in pixels.
+     * @param playerImageIndex is the index of the image for the player.
+     * @param targetImageIndex is the index of the image for the target.
+     * @param wallImageIndex is the index of the image for the walls.
+     * @param maxWallLength is the longest a wall may be, where 0 uses the
+     * width of the screen.
+     * @param attemptsPerWall is the number of candidates tried for each wall.
+     */
+    LevelGenerator(unsigned int screenWidth, unsigned int screenHeight,
+            unsigned int playerImageIndex, unsigned int targetImageIndex,
+            unsigned int wallImageIndex, unsigned int maxWallLength = 0,
+            unsigned int attemptsPerWall = 32);
+
+    /**
+     * Generates a level. The same random number generator state always
+     * generates the same level.
+     * @param r is the random number generator to use.
+     * @param numWalls is the number of walls to place.
+     * @param player is set to the Player of the level.
+     * @param target is set to the target of the level.
+     * @param walls is cleared and filled with the walls of the level.
+     * @return the GenerationResult.
+     */
+    GenerationResult generate(std::mt19937& r, unsigned int numWalls,
+            Player& player, ImageObject& target, std::vector<ImageObject>& walls);
+
+private:
+
+    /**
+     * The bounding box of a placed object, checked before the separating axis
+     * theorem.
+     */
+    struct Bounds {
+        /** The smallest x coordinate. */
+        double minX;
+        /** The smallest y coordinate. */
+        double minY;
+        /** The largest x coordinate. */
+        double maxX;
+        /** The largest y coordinate. */
+        double maxY;
+    };
+
+    /**
+     * Returns the bounding box of the given ImageObject.
+     * @param o is the ImageObject.
+     * @return the Bounds of the ImageObject.
+     */
+    static Bounds getBounds(const ImageObject& o) noexcept;
+
+    /**
+     * Returns whether the given candidate overlaps any placed object.
+     * @param candidate is the ImageObject to check.
+     * @param bounds is the bounding box of the candidate.
+     * @param player is the Player of the level.
+     * @param target is the target of the level.
+     * @param walls is the vector of walls placed so far.
+     * @return true if the candidate overlaps a placed object.
+     */
+    bool overlaps(const ImageObject& candidate, const Bounds& bounds,
+            const Player& player, const ImageObject& target,
+            const std::vector<ImageObject>& walls) noexcept;
+
+    /**
+     * Adds a placed object to the cells its bounding box covers.
+     * @param object is the index of the object: 0 for the player, 1 for the
+     * target, and 2 plus the index of the wall for walls.
+     * @param bounds is the bounding box of the object.
+     */
+    void place(unsigned int object, const Bounds& bounds);
+
+    /**
+     * Returns the column of the cell containing the given x coordinate,
+     * clamped to the grid.
+     * @param x is the x coordinate.
+     * @return an unsigned int representing the column.
+     */
+    unsigned int column(double x) const noexcept;
+
+    /**
+     * Returns the row of the cell containing the given y coordinate, clamped
+     * to the grid.
+     * @param y is the y coordinate.
+     * @return an unsigned int representing the row.
+     */
+    unsigned int row(double y) const noexcept;
+
+    /** The index of the image for the player. */
+    const unsigned int playerImageIndex_;
+
+    /** The index of the image for the target. */
+    const unsigned int targetImageIndex_;
+
+    /** The index of the image for the walls. */
+    const unsigned int wallImageIndex_;
+
+    /** The number of candidates tried for each wall. */
+    const unsigned int attemptsPerWall_;
+
+    /** The distribution for random generation of any x values. */
+    std::uniform_int_distribution<int> distrX_;
+
+    /** The distribution for random generation of any y values. */
+    std::uniform_int_distribution<int> distrY_;
+
+    /** The distribution for random generation of wall lengths. */
+    std::uniform_int_distribution<int> distrL_;
+
+    /** The distribution for random generation of angles. */
+    std::uniform_int_distribution<int> distrA_;
+
+    /** The length of the sides of each cell. */
+    double cellSize_;
+
+    /** The number of columns of cells. */
+    unsigned int columns_;
+
+    /** The number of rows of cells. */
+    unsigned int rows_;
+
+    /**
+     * For each cell, the index in nodes_ of the first object in it, or -1 if
+     * it is empty. The objects of a cell are linked through nodes_.
+     */
+    std::vector<int> cellHeads_;
+
+    /** For each entry of an object in a cell, the object and the next entry. */
+    std::vector<std::pair<unsigned int, int> > nodes_;
+
+    /** The bounding boxes of the placed objects, by object index. */
+    std::vector<Bounds> bounds_;
+
+    /**
+     * The last check each object was tested in, so an object in several of
+     * the cells is only tested once per check.
+     */
+    std::vector<unsigned int> lastCheck_;
+
+    /** The number of the current check. */
+    unsigned int check_ = 0;
+};
+}
+
+#endif /* LEVELGENERATOR_H */
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include "LevelSolver.h"
+
+using namespace std;
+using namespace deflection;
+
+LevelSolver::LevelSolver(unsigned int numAngles, unsigned int numThreads,
+        unsigned int maxTicks) noexcept
+: numAngles_(numAngles),
+numThreads_(numThreads != 0 ? numThreads : max(1u, thread::hardware_concurrency())),
+maxTicks_(maxTicks) {
+
+    // Order the directions coarse to fine: 0, then half way around, then the
+    // quarters, then the eighths, and so on
+    vector<bool> added(numAngles_, false);
+    for (unsigned int step = numAngles_; step >= 1; step /= 2) {
+        for (unsigned int i = 0; i < numAngles_; i += step) {
+            if (!added[i]) {
+                added[i] = true;
+                order_.push_back(i);
+            }
+        }
+        if (step == 1) {
+            break;
+        }
+    }
+}
+
+bool LevelSolver::shotWins(double angle, const Player& player, const ImageObject& target,
+        const vector<ImageObject>& walls, const WallGrid& grid, unsigned int numWalls,
+        unsigned int screenWidth, unsigned int screenHeight) const noexcept {
+    // Follow the shot the same way ActiveGame::updateState and
+    // ActiveGame::checkGameWon do: move it, remove it if it hit too many
+    // walls, and otherwise check if it is hitting the target
+    Projectile p = player.fireAtAngle(angle, 0);
+    double maxTicks = ceil(maxTicks_ * DEFAULT_STEP / step_);
+    for (unsigned int tick = 0; tick < maxTicks; tick += 1) {
+        p.move(step_, walls, grid, screenWidth, screenHeight);
+        if (p.getNumCollisions() > (int) numWalls) {
+            return false;
+        }
+        if (p.hits<AxisAligned, AxisAligned>(target)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SolveResult LevelSolver::solve(const Player& player, const ImageObject& target,
+        const vector<ImageObject>& walls, const WallGrid& grid, unsigned int numWalls,
+        unsigned int screenWidth, unsigned int screenHeight, bool stopAtFirstWin) const {
+    auto start = chrono::steady_clock::now();
+    SolveResult result;
+
+    // The threads take the next untried direction until there are none
+    // left, or until a win is found when stopping at the first one
+    atomic<unsigned int> next(0);
+    atomic<unsigned int> tested(0);
+    atomic<bool> won(false);
+    mutex resultMutex;
+    auto work = [&]() {
+        vector<double> angles;
+        unsigned int count = 0;
+        for (;;) {
+            if (stopAtFirstWin && won.load(memory_order_relaxed)) {
+                break;
+            }
+            unsigned int i = next.fetch_add(1, memory_order_relaxed);
+            if (i >= order_.size()) {
+                break;
+            }
+            double angle = 360.0 * order_[i] / numAngles_;
+            count += 1;
+            if (shotWins(angle, player, target, walls, grid, numWalls, screenWidth, screenHeight)) {
+                angles.push_back(angle);
+                won.store(true, memory_order_relaxed);
+            }
+        }
+        tested.fetch_add(count, memory_order_relaxed);
+        lock_guard<mutex> lock(resultMutex);
+        result.winningAngles.insert(result.winningAngles.end(), angles.begin(), angles.end());
+    };
+
+    // The calling thread does its share of the work too. If a thread cannot
+    // be started, the ones that were are told there is no work left and
+    // joined before the exception leaves, as destroying a joinable thread
+    // would terminate the program.
+    vector<thread> threads;
+    try {
+        for (unsigned int i = 1; i < numThreads_; i += 1) {
+            threads.emplace_back(work);
+        }
+    } catch (...) {
+        next.store(order_.size(), memory_order_relaxed);
+        for (thread& t : threads) {
+            t.join();
+        }
+        throw;
+    }
+    work();
+    for (thread& t : threads) {
+        t.join();
+    }
+
+    sort(result.winningAngles.begin(), result.winningAngles.end());
+    result.winnable = !result.winningAngles.empty();
+    result.anglesTested = tested.load();
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void LevelSolver::setNumThreads(unsigned int numThreads) noexcept {
+    numThreads_ = numThreads != 0 ? numThreads : max(1u, thread::hardware_concurrency());
+}
+
+void LevelSolver::setStep(double step) noexcept {
+    step_ = step;
+}
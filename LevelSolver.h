@@ -0,0 +1,131 @@
+#ifndef LEVELSOLVER_H
+#define LEVELSOLVER_H
+
+#include <vector>
+#include "Player.h"
+#include "WallGrid.h"
+
+namespace deflection {
+
+/**
+ * The result of solving a level with a LevelSolver.
+ */
+struct SolveResult {
+
+    /** Whether some shot from the player hits the target. */
+    bool winnable = false;
+
+    /** The angles, in degrees and in increasing order, of the winning shots found. */
+    std::vector<double> winningAngles;
+
+    /** The number of angles that were tested. */
+    unsigned int anglesTested = 0;
+
+    /** The real time taken to solve the level, in seconds. */
+    double seconds = 0.0;
+};
+
+/**
+ * Determines whether a level can be won, by firing shots from the player in
+ * evenly spaced directions around it and following each with the same rules
+ * and the same step per tick as the game, until it hits the target or hits
+ * too many walls. The directions are split between several threads.
+ *
+ * @author Trevor Day
+ */
+class LevelSolver {
+public:
+
+    /**
+     * The distance a shot moves each tick unless told otherwise, which is
+     * that of the game at its default 60 ticks per second.
+     */
+    static constexpr double DEFAULT_STEP = 5.0;
+
+    /**
+     * Constructs a new LevelSolver with the given parameters.
+     * @param numAngles is the number of evenly spaced directions to try.
+     * @param numThreads is the number of threads to use, where 0 uses one for
+     * each core.
+     * @param maxTicks is the most ticks a shot is followed for at the
+     * DEFAULT_STEP, so that a shot that never hits anything cannot keep the
+     * solver busy. With another step a shot is followed for the same
+     * distance.
+     */
+    LevelSolver(unsigned int numAngles = 720, unsigned int numThreads = 0,
+            unsigned int maxTicks = 4000) noexcept;
+
+    /**
+     * Solves the given level. The directions are tried coarse to fine, so when
+     * stopping at the first win, a level with a wide opening is accepted
+     * after only a few shots. Whether the level is winnable does not depend on
+     * the number of threads or on when they stop.
+     * @param player is the Player of the level.
+     * @param target is the ImageObject representing the target.
+     * @param walls is the vector of walls of the level.
+     * @param grid is the WallGrid built from the walls.
+     * @param numWalls is the number of collisions a shot may have.
+     * @param screenWidth is the width of the screen.
+     * @param screenHeight is the height of the screen.
+     * @param stopAtFirstWin is whether to stop as soon as any winning shot is
+     * found, instead of finding all of them.
+     * @return the SolveResult.
+     * @throw system_error if a thread cannot be started, once the threads
+     * that were started have been joined.
+     */
+    SolveResult solve(const Player& player, const ImageObject& target,
+            const std::vector<ImageObject>& walls, const WallGrid& grid,
+            unsigned int numWalls, unsigned int screenWidth,
+            unsigned int screenHeight, bool stopAtFirstWin = true) const;
+
+    /**
+     * Returns whether a single shot in the given direction wins the level.
+     * @param angle is the direction of the shot in degrees.
+     * @param player is the Player of the level.
+     * @param target is the ImageObject representing the target.
+     * @param walls is the vector of walls of the level.
+     * @param grid is the WallGrid built from the walls.
+     * @param numWalls is the number of collisions a shot may have.
+     * @param screenWidth is the width of the screen.
+     * @param screenHeight is the height of the screen.
+     * @return true if the shot hits the target, false otherwise.
+     */
+    bool shotWins(double angle, const Player& player, const ImageObject& target,
+            const std::vector<ImageObject>& walls, const WallGrid& grid,
+            unsigned int numWalls, unsigned int screenWidth,
+            unsigned int screenHeight) const noexcept;
+
+    /**
+     * Sets the number of threads later solves use.
+     * @param numThreads is the number of threads to use, where 0 uses one for
+     * each core and 1 solves on the calling thread alone.
+     */
+    void setNumThreads(unsigned int numThreads) noexcept;
+
+    /**
+     * Sets the distance shots move each tick in later solves, which must be
+     * that of the game for the shots to follow the same paths as in it.
+     * @param step is the distance in pixels, greater than 0.
+     */
+    void setStep(double step) noexcept;
+
+private:
+
+    /** The number of evenly spaced directions to try. */
+    const unsigned int numAngles_;
+
+    /** The number of threads to use. */
+    unsigned int numThreads_;
+
+    /** The most ticks a shot is followed for at the DEFAULT_STEP. */
+    const unsigned int maxTicks_;
+
+    /** The distance shots move each tick. */
+    double step_ = DEFAULT_STEP;
+
+    /** The indices of the directions, in the order they are tried. */
+    std::vector<unsigned int> order_;
+};
+}
+
+#endif /* LEVELSOLVER_H */
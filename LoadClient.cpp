@@ -0,0 +1,385 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <poll.h>
+
+#include "MessageStream.h"
+#include "Protocol.h"
+
+using namespace std;
+using namespace deflection;
+
+/** The longest body accepted from the server, enough for a full MSG_STATE. */
+static constexpr uint32_t MAX_SERVER_BODY = sizeof(StateMessage) + 65535 * sizeof(StateProjectile);
+
+/**
+ * The options of the load generator.
+ */
+struct LoadOptions {
+    /** The path of the Unix domain socket of the server, or empty for TCP. */
+    string socket;
+
+    /** The loopback TCP port of the server, when there is no socket path. */
+    unsigned int port = DEFAULT_PORT;
+
+    /** The number of connections the rooms are spread across. */
+    unsigned int connections = 10;
+
+    /** The number of rooms joined, starting at room 0. */
+    unsigned int rooms = 1000;
+
+    /** The number of shots fired in each room per second. */
+    double fireRate = 1.0;
+
+    /** The number of seconds to run for. */
+    unsigned int seconds = 10;
+
+    /** The seed for the shots. */
+    unsigned int seed = 1;
+
+    /** The width of the screen the shots are aimed across. */
+    unsigned int width = 640;
+
+    /** The height of the screen the shots are aimed across. */
+    unsigned int height = 480;
+
+    /** Whether to check how the server handles bad commands instead of loading it. */
+    bool check = false;
+};
+
+/**
+ * What the load generator received over a period.
+ */
+struct LoadStats {
+    /** The round trips from sending a shot to receiving its tag, in seconds. */
+    vector<double> roundTrips;
+
+    /** The number of MSG_STATEs received. */
+    unsigned long long states = 0;
+
+    /** The number of MSG_LEVELs received. */
+    unsigned long long levels = 0;
+
+    /** The number of MSG_ERRORs received. */
+    unsigned long long errors = 0;
+
+    /** The number of levels won. */
+    unsigned long long wins = 0;
+};
+
+/**
+ * Prints the usage of the load generator to the given stream.
+ * @param out is the stream to print to.
+ */
+static void printUsage(ostream& out) {
+    out << "Usage: loadclient [--socket PATH] [--port N] [--connections N] [--rooms N]"
+            << " [--fire-rate SHOTS] [--seconds N] [--seed N] [--width N] [--height N]"
+            << " [--check 0|1]" << endl;
+}
+
+/**
+ * Parses the command line arguments into load options.
+ * @param argc is the number of arguments.
+ * @param argv is the array of arguments.
+ * @return the parsed options.
+ * @throw invalid_argument if an argument is unknown or is missing its value.
+ */
+static LoadOptions parseOptions(int argc, char* argv[]) {
+    LoadOptions options;
+    for (int i = 1; i < argc; i += 1) {
+        const string name = argv[i];
+        if (i + 1 == argc) {
+            throw invalid_argument("Missing value for " + name);
+        }
+        if (name == "--socket") {
+            options.socket = argv[i + 1];
+            i += 1;
+            continue;
+        }
+        if (name == "--fire-rate") {
+            options.fireRate = stod(argv[i + 1]);
+            i += 1;
+            continue;
+        }
+        unsigned int value = stoul(argv[i + 1]);
+        i += 1;
+        if (name == "--port") {
+            options.port = value;
+        } else if (name == "--connections") {
+            options.connections = value;
+        } else if (name == "--rooms") {
+            options.rooms = value;
+        } else if (name == "--seconds") {
+            options.seconds = value;
+        } else if (name == "--seed") {
+            options.seed = value;
+        } else if (name == "--width") {
+            options.width = value;
+        } else if (name == "--height") {
+            options.height = value;
+        } else if (name == "--check") {
+            options.check = value != 0;
+        } else {
+            throw invalid_argument("Unknown option " + name);
+        }
+    }
+    if (options.port > 65535 || options.connections == 0 || options.rooms == 0
+            || options.fireRate < 0.0) {
+        throw invalid_argument("The port, connections, rooms or fire rate is out of range");
+    }
+    return options;
+}
+
+/**
+ * Prints the stats of a period.
+ * @param label is printed before the stats, naming the period.
+ * @param stats is the stats of the period.
+ * @param seconds is the length of the period, in seconds.
+ * @param numRooms is the number of rooms joined.
+ * @param bytesIn is the number of bytes received in the period.
+ * @param bytesOut is the number of bytes sent in the period.
+ */
+static void printStats(const string& label, LoadStats& stats, double seconds,
+        unsigned int numRooms, unsigned long long bytesIn, unsigned long long bytesOut) {
+    vector<double>& trips = stats.roundTrips;
+    sort(trips.begin(), trips.end());
+    cout << label << ": states: " << stats.states
+            << ", levels: " << stats.levels
+            << ", wins: " << stats.wins
+            << ", errors: " << stats.errors
+            << ", round trips: " << trips.size();
+    if (!trips.empty()) {
+        cout << ", round trip p50 ms: " << trips[trips.size() / 2] * 1000.0
+                << ", p99 ms: " << trips[min(trips.size() - 1, trips.size() * 99 / 100)] * 1000.0
+                << ", max ms: " << trips.back() * 1000.0;
+    }
+    cout << ", bytes per room per second in: " << bytesIn / seconds / numRooms
+            << ", out: " << bytesOut / seconds / numRooms << endl;
+}
+
+/**
+ * Handles a message from the server, timing the round trip of the shot
+ * whose tag a MSG_STATE echoes.
+ * @param header is the header of the message.
+ * @param body is the body of the message.
+ * @param sentTimes is the time each tag was sent since the start, in
+ * seconds, or a negative number once its round trip has been timed.
+ * @param now is the time since the start, in seconds.
+ * @param stats is the stats of the current second.
+ */
+static void handleMessage(const MessageHeader& header, const unsigned char* body,
+        vector<double>& sentTimes, double now, LoadStats& stats) {
+    if (header.type == MSG_STATE && header.length >= sizeof(StateMessage)) {
+        StateMessage state;
+        memcpy(&state, body, sizeof(state));
+        stats.states += 1;
+        stats.wins += state.won;
+        if (state.firstTag != 0 && state.firstTag < sentTimes.size() && sentTimes[state.firstTag] >= 0.0) {
+            stats.roundTrips.push_back(now - sentTimes[state.firstTag]);
+            sentTimes[state.firstTag] = -1.0;
+        }
+    } else if (header.type == MSG_LEVEL) {
+        stats.levels += 1;
+    } else if (header.type == MSG_ERROR) {
+        stats.errors += 1;
+    }
+}
+
+/**
+ * Waits for the next message from the server.
+ * @param stream is the MessageStream to read from.
+ * @param header is set to the header of the message.
+ * @param body is set to the body of the message.
+ * @throw domain_error if the server closes the connection or sends nothing
+ * for a second.
+ */
+static void waitForMessage(MessageStream& stream, MessageHeader& header,
+        const unsigned char*& body) {
+    auto start = chrono::steady_clock::now();
+    while (!stream.next(header, body)) {
+        if (!stream.flush() || stream.isBroken()) {
+            throw domain_error("The server closed the connection");
+        }
+        pollfd fd = {stream.getFd(), POLLIN, 0};
+        poll(&fd, 1, 10);
+        if (!stream.receive()) {
+            throw domain_error("The server closed the connection");
+        }
+        if (chrono::steady_clock::now() - start > chrono::seconds(1)) {
+            throw domain_error("The server did not answer");
+        }
+    }
+}
+
+/**
+ * Checks that the server rejects commands it cannot carry out, on room 0. A
+ * shot towards the exact center of the player, as MSG_LEVEL gives it, has no
+ * direction, and must be answered with a MSG_ERROR and never fired.
+ * @param options are the options of the load generator.
+ * @return true if every check passed, false otherwise.
+ */
+static bool checkServer(const LoadOptions& options) {
+    MessageStream stream(MessageStream::connect(options.socket, options.port), MAX_SERVER_BODY);
+    stream.send(MSG_JOIN, 0, nullptr, 0);
+    MessageHeader header;
+    const unsigned char* body;
+    do {
+        waitForMessage(stream, header, body);
+    } while (header.type != MSG_LEVEL);
+    LevelMessage level;
+    memcpy(&level, body, sizeof(level));
+
+    FireMessage fire = {level.playerX, level.playerY, 1};
+    stream.send(MSG_FIRE, 0, &fire, sizeof(fire));
+    bool rejected = false;
+    bool fired = false;
+    for (unsigned int states = 0; states < 10; ) {
+        waitForMessage(stream, header, body);
+        if (header.type == MSG_ERROR) {
+            rejected = true;
+        } else if (header.type == MSG_STATE) {
+            StateMessage state;
+            memcpy(&state, body, sizeof(state));
+            fired = fired || state.firstTag == fire.tag;
+            states += 1;
+        }
+    }
+    cout << "Fire at the center of the player: "
+            << (rejected && !fired ? "rejected" : "not rejected") << endl;
+    return rejected && !fired;
+}
+
+/**
+ * A load generator for the server. Joins the given number of rooms, spread
+ * across the given number of connections, fires shots into them at a steady
+ * rate at random points, and reads every message sent back. The round trip
+ * of a shot is the time from sending it to receiving the first MSG_STATE that
+ * echoes its tag, so it includes waiting for the next tick. Only the first
+ * shot into a room between two MSG_STATEs is echoed, and so timed. Once a second, and
+ * for the whole run at the end, the round trip percentiles and the bytes per
+ * room per second are printed. With --check 1, it instead checks that the
+ * server rejects bad commands, and fails if it does not.
+ * @return The status code. Status code 0 means
+ * the program succeeds, and nonzero status code
+ * means the program failed.
+ */
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        printUsage(cerr);
+        return 1;
+    }
+    try {
+        if (options.check) {
+            return checkServer(options) ? 0 : 1;
+        }
+        vector<unique_ptr<MessageStream>> streams;
+        for (unsigned int c = 0; c < options.connections; c += 1) {
+            streams.emplace_back(new MessageStream(
+                    MessageStream::connect(options.socket, options.port), MAX_SERVER_BODY));
+        }
+        for (unsigned int r = 0; r < options.rooms; r += 1) {
+            streams[r % options.connections]->send(MSG_JOIN, r, nullptr, 0);
+        }
+
+        // The shots are aimed at random points on the screen, drawn through a
+        // seed_seq so that they do not repeat the levels of the room the
+        // server seeds with the same number
+        seed_seq seeds = {options.seed};
+        mt19937 random(seeds);
+        uniform_int_distribution<int> distrX(0, options.width);
+        uniform_int_distribution<int> distrY(0, options.height);
+
+        // Tags start at 1, since 0 means no shot
+        vector<double> sentTimes(1, -1.0);
+        unsigned long long shots = 0;
+        LoadStats second;
+        LoadStats total;
+        unsigned long long lastBytesIn = 0;
+        unsigned long long lastBytesOut = 0;
+        vector<pollfd> fds;
+
+        auto start = chrono::steady_clock::now();
+        double secondStart = 0.0;
+        double now = 0.0;
+        while (now < options.seconds) {
+            // Fire the shots that are due, round robin across the rooms
+            unsigned long long due = static_cast<unsigned long long>(now * options.rooms * options.fireRate);
+            while (shots < due) {
+                unsigned int room = shots % options.rooms;
+                FireMessage fire;
+                fire.x = distrX(random);
+                fire.y = distrY(random);
+                fire.tag = static_cast<uint32_t>(sentTimes.size());
+                sentTimes.push_back(now);
+                streams[room % options.connections]->send(MSG_FIRE, room, &fire, sizeof(fire));
+                shots += 1;
+            }
+
+            fds.clear();
+            for (const unique_ptr<MessageStream>& stream : streams) {
+                if (!stream->flush()) {
+                    throw domain_error("The server closed the connection");
+                }
+                short events = POLLIN;
+                if (stream->getPendingBytes() > 0) {
+                    events |= POLLOUT;
+                }
+                fds.push_back({stream->getFd(), events, 0});
+            }
+            poll(fds.data(), fds.size(), 1);
+
+            now = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            for (unsigned int c = 0; c < streams.size(); c += 1) {
+                if (fds[c].revents == 0) {
+                    continue;
+                }
+                bool open = streams[c]->receive();
+                MessageHeader header;
+                const unsigned char* body;
+                while (streams[c]->next(header, body)) {
+                    handleMessage(header, body, sentTimes, now, second);
+                }
+                if (!open || streams[c]->isBroken()) {
+                    throw domain_error("The server closed the connection");
+                }
+            }
+
+            if (now - secondStart >= 1.0 || now >= options.seconds) {
+                unsigned long long bytesIn = 0;
+                unsigned long long bytesOut = 0;
+                for (const unique_ptr<MessageStream>& stream : streams) {
+                    bytesIn += stream->getBytesReceived();
+                    bytesOut += stream->getBytesSent();
+                }
+                total.roundTrips.insert(total.roundTrips.end(),
+                        second.roundTrips.begin(), second.roundTrips.end());
+                total.states += second.states;
+                total.levels += second.levels;
+                total.errors += second.errors;
+                total.wins += second.wins;
+                printStats("Second", second, now - secondStart, options.rooms,
+                        bytesIn - lastBytesIn, bytesOut - lastBytesOut);
+                second = LoadStats();
+                lastBytesIn = bytesIn;
+                lastBytesOut = bytesOut;
+                secondStart = now;
+            }
+        }
+        cout << "Shots: " << shots << endl;
+        printStats("Total", total, now, options.rooms, lastBytesIn, lastBytesOut);
+        return 0;
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+}
@@ -1,99 +1,328 @@
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <random>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include "Assets.h"
 #include "ImageObject.h"
 #include "Display.h"
-#include "Request.h"
+#include "EventQueue.h"
 #include "ActiveGame.h"
+#include "InputLogWriter.h"
+#include "LevelCorpus.h"
+#include "SimulationThread.h"
+#include "Trace.h"
 
 using namespace std;
 using namespace deflection;
 
+/**
+ * The time the program started, taken while its statics are initialized,
+ * before main, for --startup-time.
+ */
+static const chrono::steady_clock::time_point processStart = chrono::steady_clock::now();
+
+/**
+ * The most walls a level may have. The wall grid keeps the cost of a wall
+ * count this large small, and this is about the most the LevelGenerator
+ * places on the 640 by 480 screen of the game without running out of room.
+ */
+static constexpr int MAX_WALLS = 150;
+
 /**
  * @namespace deflection The deflection package is a game where the player
  * must fire projectiles to attempt to hit a target before the projectiles disappear.
  * Projectiles disappear after bouncing off walls a certain number of times. Players
  * can specify the number of walls they would like in their game before they start.
- * Levels are randomly generated. They are not generated in a way that guarantees
- * they are winnable, and due to this players may generate a new level at any
- * time by pressing the space bar.
+ * Levels are randomly generated, and a level is only kept once a solver has
+ * found a shot from the player that wins it, unless none of
+ * ActiveGame::MAX_LEVEL_ATTEMPTS levels in a row can be won, in which case the
+ * last is played anyway. Players may still generate a new level at any time by
+ * pressing the space bar.
  *
  * @author Trevor Day
  */
 
 /**
- * Main program for the deflection game.
+ * Main program for the deflection game. The game is simulated in fixed ticks,
+ * 60 per second by default, on its own thread, independent of the frame rate
+ * of the display, and this thread draws the latest snapshot of it.
+ * The tick rate can be changed with --tick-rate, and the most ticks run to
+ * catch up in a single frame with --max-catch-up. With --corpus, the levels of
+ * a corpus written by makecorpus are played in order instead of generated.
+ * With --record, the seed and every input are recorded to an input log, which
+ * simulate can replay with --replay. With --stats 1, the cost of drawing, the
+ * latency of the snapshots drawn and the jitter of the ticks are printed once
+ * a second. When built with DEFLECTION_TRACE, each phase of each
+ * frame is traced: --trace writes the trace as Chrome trace events when the
+ * window is closed, and --trace-summary 1 prints the p50 and p99 length of
+ * each phase once a second. --walls skips asking for the number of walls, and
+ * --startup-time 1 prints how long each step of starting took, up to the
+ * first frame being presented, and then quits.
  * @return The status code. Status code 0 means
  * the program succeeds, and nonzero status code
  * means the program failed.
  */
-int main() {
+int main(int argc, char* argv[]) {
     try {
+        auto mainStart = chrono::steady_clock::now();
 
-        // Set up a temp variable to hold the number and prompt the player
-        // to input a number
+        // Read the simulation options
+        double tickRate = 60.0;
+        unsigned int maxCatchUp = 5;
+        string corpusLocation;
+        string recordLocation;
+        bool showStats = false;
+        string traceLocation;
+        bool showTraceSummary = false;
         int numWalls = 0;
-        cout << "Please enter a number of walls, greater than zero and less than eleven:" << endl;
+        bool showStartupTime = false;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            const string name = argv[i];
+            if (name == "--tick-rate") {
+                tickRate = stod(argv[i + 1]);
+            } else if (name == "--max-catch-up") {
+                maxCatchUp = stoul(argv[i + 1]);
+            } else if (name == "--corpus") {
+                corpusLocation = argv[i + 1];
+            } else if (name == "--record") {
+                recordLocation = argv[i + 1];
+            } else if (name == "--stats") {
+                showStats = stoul(argv[i + 1]) != 0;
+            } else if (name == "--trace") {
+                traceLocation = argv[i + 1];
+            } else if (name == "--trace-summary") {
+                showTraceSummary = stoul(argv[i + 1]) != 0;
+            } else if (name == "--walls") {
+                numWalls = stoi(argv[i + 1]);
+                if (numWalls < 1 || numWalls > MAX_WALLS) {
+                    throw invalid_argument("The number of walls must be from 1 to "
+                            + to_string(MAX_WALLS));
+                }
+            } else if (name == "--startup-time") {
+                showStartupTime = stoul(argv[i + 1]) != 0;
+            } else {
+                throw invalid_argument("Unknown option " + name);
+            }
+        }
+        if (tickRate <= 0.0) {
+            throw invalid_argument("The tick rate must be positive");
+        }
+        if ((!traceLocation.empty() || showTraceSummary) && !Tracer::ENABLED) {
+            cerr << "Tracing needs a build with -DDEFLECTION_TRACE" << endl;
+        }
 
-        // Keep reading inputs until one of them matches the necessary range
-        while (cin >> numWalls) {
-            if (numWalls >= 1 && numWalls <= 10) {
-                break;
+        // Open the corpus of levels, if there is one
+        unique_ptr<LevelCorpus> corpus;
+        if (!corpusLocation.empty()) {
+            corpus.reset(new LevelCorpus(corpusLocation));
+            if (corpus->size() == 0) {
+                throw domain_error("The level corpus " + corpusLocation + " has no levels");
+            }
+        }
+
+        // Prompt the player to input a number of walls, unless it was
+        // given or the levels come from a corpus. Measuring the startup time
+        // does not wait for the player.
+        if (corpus) {
+            numWalls = corpus->getLevel(0).numWalls;
+        } else if (numWalls == 0 && showStartupTime) {
+            numWalls = 10;
+        } else if (numWalls == 0) {
+            cout << "Please enter a number of walls, from 1 to " << MAX_WALLS << ":" << endl;
+
+            // Keep reading inputs until one of them matches the necessary range
+            while (cin >> numWalls) {
+                if (numWalls >= 1 && numWalls <= MAX_WALLS) {
+                    break;
+                }
             }
         }
 
         // Initialize the graphical display
+        auto displayStart = chrono::steady_clock::now();
         Display display;
+        auto displayReady = chrono::steady_clock::now();
 
-        // Add some images to the display
-        int playerImageIndex = display.addImage("graphics/blue.bmp");
-        int targetImageIndex = display.addImage("graphics/green.bmp");
-        int wallImageIndex = display.addImage("graphics/black.bmp");
-        int projectileImageIndex = display.addImage("graphics/red.bmp");
+        // Add the images compiled into the program to the display
+        int playerImageIndex = display.addImage(assets::BLUE_BMP, sizeof(assets::BLUE_BMP), "blue");
+        int targetImageIndex = display.addImage(assets::GREEN_BMP, sizeof(assets::GREEN_BMP), "green");
+        int wallImageIndex = display.addImage(assets::BLACK_BMP, sizeof(assets::BLACK_BMP), "black");
+        int projectileImageIndex = display.addImage(assets::RED_BMP, sizeof(assets::RED_BMP), "red");
+        auto imagesReady = chrono::steady_clock::now();
 
-        // Start the game with the proper variables
+        // Start the game with the proper variables, choosing the seed here
+        // so that it can be recorded
+        unsigned int seed = random_device()();
         ActiveGame game(640, 480, playerImageIndex, targetImageIndex,
-                wallImageIndex, projectileImageIndex, numWalls);
+                wallImageIndex, projectileImageIndex, numWalls, seed);
+
+        // Only play levels that can be won. Levels from a corpus are played
+        // in order, wrapping around at the end.
+        unsigned int corpusLevel = 0;
+        auto nextLevel = [&]() {
+            if (corpus) {
+                game.startLevel(*corpus, corpusLevel % corpus->size());
+                corpusLevel += 1;
+            } else {
+                game.startNewGame();
+            }
+        };
+        game.setNumThreads(0);
+        game.setTickSeconds(1.0 / tickRate);
+        game.setRequireWinnable(!corpus);
+        nextLevel();
+        auto levelReady = chrono::steady_clock::now();
         
-        // Keep track of the number of levels they have beaten
-        int numLevelsBeaten = 0;
+        // Record the session if asked to, with each input stamped with the
+        // number of ticks simulated before it
+        unique_ptr<InputLogWriter> log;
+        if (!recordLocation.empty()) {
+            InputLogHeader header = {};
+            header.seed = seed;
+            header.numWalls = numWalls;
+            header.screenWidth = 640;
+            header.screenHeight = 480;
+            header.flags = corpus ? INPUT_LOG_CORPUS : INPUT_LOG_WINNABLE;
+            header.tickRate = tickRate;
+            log.reset(new InputLogWriter(recordLocation, header));
+        }
+
+        // Simulate the game in fixed ticks on its own thread, which takes
+        // the input of each frame and publishes a snapshot after its ticks
+        SimulationThread simulation(game, tickRate, maxCatchUp, nextLevel, log.get());
+        TripleBuffer<FrameSnapshot>& snapshots = simulation.getSnapshots();
+        simulation.start();
+
+        // The cost of drawing, summed over the frames since it was last
+        // printed, and how old each snapshot was once it was presented
+        RenderStats statsTotal;
+        unsigned int statsFrames = 0;
+        vector<double> latencies;
+        auto lastStats = chrono::steady_clock::now();
+        auto lastTraceSummary = lastStats;
+
+        // The input of each frame, reused between frames
+        EventQueue events;
 
         // Run until quit.
-        for (;;) {
+        bool quit = false;
+        while (!quit && simulation.isRunning()) {
+            DEFLECTION_TRACE_SCOPE("frame");
 
-            // Check all pending requests.
-            for (;;) {
-                shared_ptr<Request> request = display.getNextRequest();
-                if (!request) {
-                    break;
-                }
-                if (request->shouldQuit()) {
+            // Check all pending input, and pass it to the simulation
+            events.clear();
+            {
+                DEFLECTION_TRACE_SCOPE("pollEvents");
+                display.pollEvents(events);
+            }
+            for (unsigned int i = 0; i < events.size(); i += 1) {
+                const InputEvent& event = events[i];
+                if (event.type == InputType::Quit) {
                     // Request to close the window
                     cout << "User closed the window" << endl;
-                    return 0;
-                } else if (request->shouldRestart()) {
-                    // Request to reset the game
-                    game.startNewGame();
-                } else if (request->pressedButton()) {
-                    // Pressed the left mouse button
-                    game.playerFire(request->xPosition(), request->yPosition());
+                    quit = true;
+                    break;
+                }
+                while (!simulation.getInputs().push(event) && simulation.isRunning()) {
+                    this_thread::yield();
                 }
             }
+            if (quit) {
+                break;
+            }
 
-            // Update the state of the game and redraw the graphics, and
-            // check if the game has been won
-            game.updateState();
-            display.refresh(game.getImagesToDraw());
-            if (game.checkGameWon()) {
-                // Increment levels beaten
-                numLevelsBeaten += 1;
-                // Output number of levels beaten
-                cout << "Beat level! Number of levels beaten: " << numLevelsBeaten << endl;
-                // Generate new level
-                game.startNewGame();
+            // Redraw the graphics from the latest snapshot, between its last
+            // two ticks
+            snapshots.update();
+            const FrameSnapshot& snapshot = snapshots.front();
+            auto now = chrono::steady_clock::now();
+            double alpha = chrono::duration<double>(now - snapshot.tickTime).count()
+                    / snapshot.tickSeconds;
+            {
+                DEFLECTION_TRACE_SCOPE("refresh");
+                display.refresh(snapshot.draws.data(), snapshot.draws.size(),
+                        min(1.0, max(0.0, alpha)));
             }
+            auto presented = chrono::steady_clock::now();
+            latencies.push_back(chrono::duration<double>(presented - snapshot.publishTime).count());
+
+            // Print how long it took to get here the first time, and quit
+            if (showStartupTime) {
+                auto ms = [](chrono::steady_clock::duration d) {
+                    return chrono::duration<double, milli>(d).count();
+                };
+                cout << "Startup ms: " << ms(presented - processStart)
+                        << ", before main: " << ms(mainStart - processStart)
+                        << ", options: " << ms(displayStart - mainStart)
+                        << ", display: " << ms(displayReady - displayStart)
+                        << ", images: " << ms(imagesReady - displayReady)
+                        << ", level: " << ms(levelReady - imagesReady)
+                        << ", first frame: " << ms(presented - levelReady) << endl;
+                break;
+            }
+
+            // Print the length of each phase over the last second
+            if (showTraceSummary && Tracer::ENABLED && now - lastTraceSummary >= chrono::seconds(1)) {
+                Tracer::instance().writeSummary(cout, 1000000000ull);
+                lastTraceSummary = now;
+            }
+
+            // Print the mean cost of drawing a frame, the latency of the
+            // snapshots drawn and the jitter of the ticks once a second
+            const RenderStats& stats = display.getRenderStats();
+            statsTotal.objects += stats.objects;
+            statsTotal.drawCalls += stats.drawCalls;
+            statsTotal.buildSeconds += stats.buildSeconds;
+            statsTotal.submitSeconds += stats.submitSeconds;
+            statsTotal.presentSeconds += stats.presentSeconds;
+            statsFrames += 1;
+            if (now - lastStats >= chrono::seconds(1)) {
+                if (showStats) {
+                    sort(latencies.begin(), latencies.end());
+                    const SimulationStats& sim = snapshot.stats;
+                    cout << "Frames: " << statsFrames
+                            << ", objects: " << statsTotal.objects / statsFrames
+                            << ", draw calls: " << statsTotal.drawCalls / statsFrames
+                            << ", build ms: " << statsTotal.buildSeconds * 1000.0 / statsFrames
+                            << ", submit ms: " << statsTotal.submitSeconds * 1000.0 / statsFrames
+                            << ", present ms: " << statsTotal.presentSeconds * 1000.0 / statsFrames
+                            << ", latency p50 ms: " << latencies[latencies.size() / 2] * 1000.0
+                            << ", latency p99 ms: "
+                            << latencies[min(latencies.size() - 1, latencies.size() * 99 / 100)] * 1000.0
+                            << endl;
+                    cout << "Ticks: " << sim.ticks
+                            << ", jitter p50 ms: " << sim.jitterP50 * 1000.0
+                            << ", jitter p99 ms: " << sim.jitterP99 * 1000.0
+                            << ", jitter max ms: " << sim.jitterMax * 1000.0
+                            << ", dropped: " << sim.droppedTicks << endl;
+                }
+                statsTotal = RenderStats();
+                statsFrames = 0;
+                latencies.clear();
+                lastStats = now;
+            }
+        }
+
+        // Stop the simulation, which rethrows anything that stopped it
+        // early, and end the recording at the tick it stopped at
+        simulation.stop();
+        if (log) {
+            log->record(game.getTick(), INPUT_END);
+            log->flush();
+        }
+        if (!traceLocation.empty() && Tracer::ENABLED) {
+            ofstream trace(traceLocation);
+            Tracer::instance().writeChromeTrace(trace);
         }
+        return 0;
     } catch (const exception& e) {
         cerr << e.what() << endl;
         return 1;
@@ -0,0 +1,136 @@
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "ActiveGame.h"
+#include "LevelCorpusWriter.h"
+
+using namespace std;
+using namespace deflection;
+
+/**
+ * The options of a corpus generation run.
+ */
+struct CorpusOptions {
+    /** The number of levels to generate. */
+    unsigned int levels = 1000;
+
+    /** The number of walls in each level. */
+    unsigned int walls = 10;
+
+    /** The seed for level generation. */
+    unsigned int seed = 1;
+
+    /** The width of the screen. */
+    unsigned int width = 640;
+
+    /** The height of the screen. */
+    unsigned int height = 480;
+
+    /** Whether only winnable levels are generated. */
+    bool winnable = true;
+
+    /** The location of the corpus file to write. */
+    string out = "levels.dflc";
+};
+
+/**
+ * Prints the usage of the corpus generator to the given stream.
+ * @param out is the stream to print to.
+ */
+static void printUsage(ostream& out) {
+    out << "Usage: makecorpus [--levels N] [--walls N] [--seed N] [--width N]"
+            << " [--height N] [--winnable 0|1] [--out FILE]" << endl;
+}
+
+/**
+ * Parses the command line arguments into corpus options.
+ * @param argc is the number of arguments.
+ * @param argv is the array of arguments.
+ * @return the parsed options.
+ * @throw invalid_argument if an argument is unknown or is missing its value.
+ */
+static CorpusOptions parseOptions(int argc, char* argv[]) {
+    CorpusOptions options;
+    for (int i = 1; i < argc; i += 1) {
+        const string name = argv[i];
+        if (i + 1 == argc) {
+            throw invalid_argument("Missing value for " + name);
+        }
+        const string value = argv[i + 1];
+        i += 1;
+        if (name == "--out") {
+            options.out = value;
+        } else if (name == "--levels") {
+            options.levels = stoul(value);
+        } else if (name == "--walls") {
+            options.walls = stoul(value);
+        } else if (name == "--seed") {
+            options.seed = stoul(value);
+        } else if (name == "--width") {
+            options.width = stoul(value);
+        } else if (name == "--height") {
+            options.height = stoul(value);
+        } else if (name == "--winnable") {
+            options.winnable = stoul(value) != 0;
+        } else {
+            throw invalid_argument("Unknown option " + name);
+        }
+    }
+    return options;
+}
+
+/**
+ * Generates a corpus of levels ahead of time, so that the game and the
+ * headless simulation can load them with a LevelCorpus instead of generating
+ * and solving levels as they play. By default only winnable levels are kept,
+ * so a corpus of crowded levels may have fewer levels than asked for.
+ * @return The status code. Status code 0 means
+ * the program succeeds, and nonzero status code
+ * means the program failed.
+ */
+int main(int argc, char* argv[]) {
+    try {
+        CorpusOptions options = parseOptions(argc, argv);
+
+        // Image indices are not stored in a corpus
+        ActiveGame game(options.width, options.height, 0, 1, 2, 3,
+                options.walls, options.seed);
+        auto start = chrono::steady_clock::now();
+        if (options.winnable) {
+            game.setRequireWinnable(true);
+            game.startNewGame();
+        }
+
+        // The levels are the same, in the same order, as the ones simulate
+        // plays with the same options. startNewGame keeps an unwinnable level
+        // when it cannot find a winnable one, so each level is solved again
+        // and skipped if it cannot be won.
+        LevelCorpusWriter writer(options.out, options.width, options.height);
+        unsigned int skipped = 0;
+        for (unsigned int level = 0; level < options.levels; level += 1) {
+            if (level > 0) {
+                game.startNewGame();
+            }
+            if (options.winnable && !game.solveLevel().winnable) {
+                skipped += 1;
+                continue;
+            }
+            writer.add(game.getPlayer(), game.getTarget(), game.getWalls());
+        }
+        writer.close();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        cout << "Wrote " << writer.size() << " levels to " << options.out
+                << " in " << seconds << " seconds" << endl;
+        if (skipped > 0) {
+            cout << "Skipped " << skipped << " levels that could not be won" << endl;
+        }
+        return 0;
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        printUsage(cerr);
+        return 1;
+    }
+}
@@ -0,0 +1,231 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "MessageStream.h"
+
+using namespace std;
+using namespace deflection;
+
+/** The most bytes read from a socket at once. */
+static constexpr size_t READ_SIZE = 65536;
+
+#ifdef MSG_NOSIGNAL
+/** Writing to a socket the other end has closed fails instead of raising SIGPIPE. */
+static constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static constexpr int SEND_FLAGS = 0;
+#endif
+
+/**
+ * Fills in the address of a Unix domain socket.
+ * @param address is set to the address.
+ * @param socketPath is the path of the socket.
+ * @throw domain_error if the path is too long.
+ */
+static void makeUnixAddress(sockaddr_un& address, const string& socketPath) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        throw domain_error("The socket path " + socketPath + " is too long");
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+}
+
+/**
+ * Fills in the loopback address with the given port.
+ * @param address is set to the address.
+ * @param port is the TCP port.
+ */
+static void makeLoopbackAddress(sockaddr_in& address, uint16_t port) noexcept {
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+}
+
+/**
+ * Makes the given socket non-blocking, and turns off Nagle's algorithm for a
+ * TCP socket, so that small messages are sent straight away.
+ * @param fd is the file descriptor of the socket.
+ */
+static void configureSocket(int fd) noexcept {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+MessageStream::MessageStream(int fd, uint32_t maxBody) noexcept
+: fd_(fd), maxBody_(maxBody) {
+    configureSocket(fd_);
+}
+
+MessageStream::~MessageStream() {
+    close(fd_);
+}
+
+int MessageStream::listen(const string& socketPath, uint16_t port) {
+    int fd;
+    int result;
+    if (!socketPath.empty()) {
+        sockaddr_un address;
+        makeUnixAddress(address, socketPath);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(socketPath.c_str());
+        result = fd < 0 ? -1 : bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    } else {
+        sockaddr_in address;
+        makeLoopbackAddress(address, port);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        int on = 1;
+        if (fd >= 0) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        }
+        result = fd < 0 ? -1 : bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    }
+    if (result == 0) {
+        result = ::listen(fd, SOMAXCONN);
+    }
+    if (result != 0) {
+        string reason = strerror(errno);
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw domain_error("Unable to listen for connections: " + reason);
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+}
+
+int MessageStream::connect(const string& socketPath, uint16_t port) {
+    int fd;
+    int result;
+    if (!socketPath.empty()) {
+        sockaddr_un address;
+        makeUnixAddress(address, socketPath);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        result = fd < 0 ? -1 : ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    } else {
+        sockaddr_in address;
+        makeLoopbackAddress(address, port);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        result = fd < 0 ? -1 : ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    }
+    if (result != 0) {
+        string reason = strerror(errno);
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw domain_error("Unable to connect to the server: " + reason);
+    }
+    return fd;
+}
+
+int MessageStream::getFd() const noexcept {
+    return fd_;
+}
+
+bool MessageStream::receive() noexcept {
+    // Drop the messages already taken, so the buffer does not grow
+    if (inputStart_ > 0) {
+        input_.erase(input_.begin(), input_.begin() + inputStart_);
+        inputStart_ = 0;
+    }
+    // Leave the rest in the socket once a whole message and a read more are
+    // buffered, so a client sending faster than its messages are taken is
+    // held back by the socket rather than growing the buffer
+    const size_t limit = READ_SIZE + sizeof(MessageHeader) + maxBody_;
+    while (input_.size() < limit) {
+        size_t size = input_.size();
+        input_.resize(size + READ_SIZE);
+        ssize_t count = recv(fd_, input_.data() + size, READ_SIZE, 0);
+        input_.resize(size + (count > 0 ? count : 0));
+        if (count > 0) {
+            bytesReceived_ += count;
+        } else if (count == 0) {
+            return false;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return true;
+        } else if (errno != EINTR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MessageStream::next(MessageHeader& header, const unsigned char*& body) noexcept {
+    if (broken_ || input_.size() - inputStart_ < sizeof(MessageHeader)) {
+        return false;
+    }
+    memcpy(&header, input_.data() + inputStart_, sizeof(MessageHeader));
+    if (header.length > maxBody_) {
+        broken_ = true;
+        return false;
+    }
+    if (input_.size() - inputStart_ - sizeof(MessageHeader) < header.length) {
+        return false;
+    }
+    body = input_.data() + inputStart_ + sizeof(MessageHeader);
+    inputStart_ += sizeof(MessageHeader) + header.length;
+    return true;
+}
+
+bool MessageStream::isBroken() const noexcept {
+    return broken_;
+}
+
+void MessageStream::send(uint16_t type, uint32_t room, const void* body, uint32_t length) {
+    MessageHeader header = {type, 0, length, room};
+    append(reinterpret_cast<const unsigned char*>(&header), sizeof(header));
+    if (length > 0) {
+        append(static_cast<const unsigned char*>(body), length);
+    }
+}
+
+void MessageStream::append(const unsigned char* bytes, size_t size) {
+    output_.insert(output_.end(), bytes, bytes + size);
+}
+
+bool MessageStream::flush() noexcept {
+    while (outputStart_ < output_.size()) {
+        ssize_t count = ::send(fd_, output_.data() + outputStart_,
+                output_.size() - outputStart_, SEND_FLAGS);
+        if (count > 0) {
+            outputStart_ += count;
+            bytesSent_ += count;
+        } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else if (count < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+
+    // Drop the bytes written, once they are at least half the buffer, so that
+    // the rest is not moved for every partial write
+    if (outputStart_ == output_.size()) {
+        output_.clear();
+        outputStart_ = 0;
+    } else if (outputStart_ * 2 >= output_.size()) {
+        output_.erase(output_.begin(), output_.begin() + outputStart_);
+        outputStart_ = 0;
+    }
+    return true;
+}
+
+size_t MessageStream::getPendingBytes() const noexcept {
+    return output_.size() - outputStart_;
+}
+
+unsigned long long MessageStream::getBytesReceived() const noexcept {
+    return bytesReceived_;
+}
+
+unsigned long long MessageStream::getBytesSent() const noexcept {
+    return bytesSent_;
+}
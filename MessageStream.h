@@ -0,0 +1,165 @@
+#ifndef MESSAGESTREAM_H
+#define MESSAGESTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Protocol.h"
+
+namespace deflection {
+
+/**
+ * A connection between the server and a client, framing the bytes of a
+ * non-blocking socket into messages of the Protocol. Reading and writing
+ * never wait: receive takes whatever bytes have arrived and next hands out
+ * the messages that are complete, while send only appends to a buffer that
+ * flush writes as much of as the socket takes.
+ *
+ * @author Trevor Day
+ */
+class MessageStream {
+public:
+
+    /**
+     * Constructs a new MessageStream over the given socket, making it
+     * non-blocking. The stream owns the socket and closes it when destructed.
+     * @param fd is the file descriptor of a connected socket.
+     * @param maxBody is the longest body of a message that is accepted.
+     */
+    MessageStream(int fd, std::uint32_t maxBody) noexcept;
+
+    /**
+     * Destruct the MessageStream, closing its socket.
+     */
+    ~MessageStream();
+
+    MessageStream(const MessageStream&) = delete;
+    MessageStream& operator=(const MessageStream&) = delete;
+
+    /**
+     * Opens a socket listening for connections, on the Unix domain socket at
+     * the given path if there is one, or on the given port of the loopback
+     * address. A file left at the path by an earlier server is replaced.
+     * @param socketPath is the path of the Unix domain socket, or empty.
+     * @param port is the TCP port, used when there is no path.
+     * @return the file descriptor of the non-blocking listening socket.
+     * @throw domain_error if the socket cannot be opened.
+     */
+    static int listen(const std::string& socketPath, std::uint16_t port);
+
+    /**
+     * Connects to a server listening as by listen.
+     * @param socketPath is the path of the Unix domain socket, or empty.
+     * @param port is the TCP port, used when there is no path.
+     * @return the file descriptor of the connected socket.
+     * @throw domain_error if the server cannot be reached.
+     */
+    static int connect(const std::string& socketPath, std::uint16_t port);
+
+    /**
+     * Returns the file descriptor of the socket, to poll it.
+     * @return the file descriptor.
+     */
+    int getFd() const noexcept;
+
+    /**
+     * Reads the bytes that have arrived on the socket, up to a little more
+     * than the longest message accepted beyond those not yet taken by next.
+     * Any more are left in the socket for the next call.
+     * @return false if the other end has closed the connection or it failed,
+     * true otherwise.
+     */
+    bool receive() noexcept;
+
+    /**
+     * Takes the next complete message that has been received, if there is
+     * one. The body is only valid until the next call to receive.
+     * @param header is set to the header of the message.
+     * @param body is set to the first byte of the body of the message.
+     * @return true if there was a message, false if there is none yet or the
+     * stream is broken.
+     */
+    bool next(MessageHeader& header, const unsigned char*& body) noexcept;
+
+    /**
+     * Returns whether a message too long to be accepted was received, after
+     * which no more messages are taken and the connection should be closed.
+     * @return true if the stream is broken.
+     */
+    bool isBroken() const noexcept;
+
+    /**
+     * Appends a message to the bytes waiting to be sent.
+     * @param type is the kind of message, one of the MSG constants.
+     * @param room is the room the message is about.
+     * @param body is the body of the message, or nullptr if it is empty.
+     * @param length is the number of bytes of the body.
+     */
+    void send(std::uint16_t type, std::uint32_t room, const void* body, std::uint32_t length);
+
+    /**
+     * Appends bytes holding whole messages, such as those a room wrote for
+     * every client in it, to the bytes waiting to be sent.
+     * @param bytes is the first of the bytes.
+     * @param size is the number of bytes.
+     */
+    void append(const unsigned char* bytes, std::size_t size);
+
+    /**
+     * Writes as many of the bytes waiting to be sent as the socket takes.
+     * @return false if the connection failed, true otherwise.
+     */
+    bool flush() noexcept;
+
+    /**
+     * Returns the number of bytes waiting to be sent, which grows when the
+     * other end reads more slowly than messages are sent.
+     * @return the number of bytes.
+     */
+    std::size_t getPendingBytes() const noexcept;
+
+    /**
+     * Returns the number of bytes received since the stream was constructed.
+     * @return the number of bytes.
+     */
+    unsigned long long getBytesReceived() const noexcept;
+
+    /**
+     * Returns the number of bytes sent since the stream was constructed.
+     * @return the number of bytes.
+     */
+    unsigned long long getBytesSent() const noexcept;
+
+private:
+
+    /** The file descriptor of the socket. */
+    int fd_;
+
+    /** The longest body of a message that is accepted. */
+    std::uint32_t maxBody_;
+
+    /** The bytes received, starting at inputStart_. */
+    std::vector<unsigned char> input_;
+
+    /** The position of the first byte of input_ not yet taken by next. */
+    std::size_t inputStart_ = 0;
+
+    /** The bytes waiting to be sent, starting at outputStart_. */
+    std::vector<unsigned char> output_;
+
+    /** The position of the first byte of output_ not yet written. */
+    std::size_t outputStart_ = 0;
+
+    /** Whether a message too long to be accepted was received. */
+    bool broken_ = false;
+
+    /** The number of bytes received. */
+    unsigned long long bytesReceived_ = 0;
+
+    /** The number of bytes sent. */
+    unsigned long long bytesSent_ = 0;
+};
+}
+
+#endif /* MESSAGESTREAM_H */
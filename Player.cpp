@@ -2,6 +2,10 @@
 #include "Player.h"
 
 #include <iostream>
+
+// A definition of pi
+#define PI 3.14159265
+
 using namespace std;
 using namespace deflection;
 
@@ -15,5 +19,14 @@ Projectile Player::fire(int x, int y, unsigned int projectileImageIndex) const n
     double vx = (x - cx_) / total;
     double vy = (y - cy_) / total;
 
-    return Projectile(projectileImageIndex, cx_, cy_, vx, vy, 10);
+    return Projectile(projectileImageIndex, cx_, cy_, vx, vy, PROJECTILE_SIDE_LENGTH);
+}
+
+Projectile Player::fireAtAngle(double angle, unsigned int projectileImageIndex) const noexcept {
+    // Normalize the velocities as fractions of 1, the same as fire does
+    double dx = cos(angle * PI / 180.0);
+    double dy = sin(angle * PI / 180.0);
+    double total = abs(dx) + abs(dy);
+
+    return Projectile(projectileImageIndex, cx_, cy_, dx / total, dy / total, PROJECTILE_SIDE_LENGTH);
 }
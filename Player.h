@@ -13,6 +13,9 @@ namespace deflection {
 class Player : public ImageObject {
 public:
 
+    /** The length of the sides of the projectiles fired by Players. */
+    static constexpr double PROJECTILE_SIDE_LENGTH = 10.0;
+
     /**
      * Constructs a new Player with the given arguments.
      * @param imageIndex is an unsigned int representing the index of the image
@@ -36,6 +39,17 @@ public:
      * it is fired.
      */
     Projectile fire(int x, int y, unsigned int projectileImageIndex) const noexcept;
+
+    /**
+     * Returns a projectile fired from this Player in the given direction,
+     * with the proper velocity.
+     * @param angle is the direction to fire in, in degrees, measured the same
+     * way as the angles of ImageObjects.
+     * @param projectileImageIndex is the index of the image loaded in SDL to
+     * use for projectiles.
+     * @return a new Projectile which has the correct normalized velocity.
+     */
+    Projectile fireAtAngle(double angle, unsigned int projectileImageIndex) const noexcept;
 };
 }
 
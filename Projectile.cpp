@@ -14,51 +14,87 @@ int Projectile::getNumCollisions() const noexcept {
     return numCollisions_;
 }
 
-void Projectile::move(double delta, const std::vector<ImageObject>& walls,
+double Projectile::getVelocityX() const noexcept {
+    return vx_;
+}
+
+double Projectile::getVelocityY() const noexcept {
+    return vy_;
+}
+
+int Projectile::bounceOffWalls(ImageObject& body, double& vx, double& vy,
+        const vector<ImageObject>& walls, const WallGrid& grid) noexcept {
+    int numCollisions = 0;
+
+    // Find the walls hit by the body, in the same order as they appear in
+    // the vector of walls. The buffer is reused between calls so that
+    // bouncing does not allocate.
+    static thread_local vector<unsigned int> hit;
+    grid.findHits(body.getCenterX(), body.getCenterY(),
+            body.getWidth() / 2.0, body.getLength() / 2.0, hit);
+
+    // Pushing the body out of one wall may also take it out of the next, so
+    // the contact with each is found from where the body is by then
+    for (unsigned int i : hit) {
+        Contact contact = body.contact<AxisAligned, Oriented>(walls[i]);
+        if (!contact.hit) {
+            continue;
+        }
+        const Vec2& n = contact.normal;
+        body.setCenter(body.getCenterX() + n.x * (contact.depth + CONTACT_SKIN),
+                body.getCenterY() + n.y * (contact.depth + CONTACT_SKIN));
+
+        // Reflect the velocity about the wall if it is heading into it
+        double into = vx * n.x + vy * n.y;
+        if (into < 0.0) {
+            vx -= 2.0 * into * n.x;
+            vy -= 2.0 * into * n.y;
+            // Normalize returned velocity
+            double total = abs(vx) + abs(vy);
+            vx = vx / total;
+            vy = vy / total;
+
+            // Increment collisions
+            numCollisions += 1;
+        }
+    }
+    return numCollisions;
+}
+
+void Projectile::move(double delta, const vector<ImageObject>& walls, const WallGrid& grid,
         const unsigned int screenWidth, const unsigned int screenHeight) noexcept {
 
     double sideLength = width_ / 2.0;
+    double x = cx_;
+    double y = cy_;
 
     // Bounce against screen edges
 
-    if (cx_ < sideLength) {
-        cx_ = 2 * sideLength - cx_;
+    if (x < sideLength) {
+        x = 2 * sideLength - x;
         vx_ = -vx_;
         numCollisions_ += 1;
     }
-    if (cy_ < sideLength) {
-        cy_ = 2 * sideLength - cy_;
+    if (y < sideLength) {
+        y = 2 * sideLength - y;
         vy_ = -vy_;
         numCollisions_ += 1;
     }
-    if (cx_ > screenWidth - sideLength) {
-        cx_ = 2 * (screenWidth - sideLength) - cx_;
+    if (x > screenWidth - sideLength) {
+        x = 2 * (screenWidth - sideLength) - x;
         vx_ = -vx_;
         numCollisions_ += 1;
     }
-    if (cy_ > screenHeight - sideLength) {
-        cy_ = 2 * (screenHeight - sideLength) - cy_;
+    if (y > screenHeight - sideLength) {
+        y = 2 * (screenHeight - sideLength) - y;
         vy_ = -vy_;
         numCollisions_ += 1;
     }
+    setCenter(x, y);
 
     // Bounce against walls
-    for (const ImageObject& w : walls) {
-        if (hits(w)) {
-            pair<double, double> temp = bounce(w, vx_, vy_);
-            vx_ = get<0>(temp);
-            vy_ = get<1>(temp);
-            // Normalize returned velocity
-            double total = abs(vx_) + abs(vy_);
-            vx_ = vx_ / total;
-            vy_ = vy_ / total;
-
-            // Increment collisions
-            numCollisions_ += 1;
-        }
-    }
+    numCollisions_ += bounceOffWalls(*this, vx_, vy_, walls, grid);
 
     // Update position
-    cx_ += delta * vx_;
-    cy_ += delta * vy_;
+    setCenter(cx_ + delta * vx_, cy_ + delta * vy_);
 }
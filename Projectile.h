@@ -1,7 +1,9 @@
 #ifndef PROJECTILE_H
 #define PROJECTILE_H
 
+#include <vector>
 #include "ImageObject.h"
+#include "WallGrid.h"
 
 namespace deflection {
 
@@ -13,6 +15,13 @@ namespace deflection {
 class Projectile : public ImageObject {
 public:
 
+    /**
+     * How far past the surface of a wall a projectile is pushed out of it,
+     * in pixels, so that it is left just clear of the wall rather than
+     * exactly touching it.
+     */
+    static constexpr double CONTACT_SKIN = 1e-3;
+
     /**
      * Constructs a new Projectile using the given arguments.
      * @param imageIndex is an unsigned int representing the index of the image
@@ -32,19 +41,53 @@ public:
      */
     int getNumCollisions() const noexcept;
 
+    /**
+     * Returns the x velocity of this Projectile.
+     * @return a double representing the x velocity.
+     */
+    double getVelocityX() const noexcept;
+
+    /**
+     * Returns the y velocity of this Projectile.
+     * @return a double representing the y velocity.
+     */
+    double getVelocityY() const noexcept;
+
     /**
      * Moves this Projectile according to the given delta, also checks for
      * collisions with the vector of Walls and the top, bottom, and sides of
      * the screen, and bounces it accordingly. Also increments
-     * the number of collisions if necessary.
+     * the number of collisions if necessary. Only the walls that the grid has
+     * in the cells around this Projectile are checked.
      * @param delta is the delta of time to move this Projectile by.
      * @param walls is the vector of Walls to check for collisions.
+     * @param grid is the WallGrid built from the vector of Walls.
      * @param screenWidth is the width of the screen.
      * @param screenHeight is the height of the screen.
      */
-    void move(double delta, const std::vector<ImageObject>& walls,
+    void move(double delta, const std::vector<ImageObject>& walls, const WallGrid& grid,
             const unsigned int screenWidth, const unsigned int screenHeight) noexcept;
 
+    /**
+     * A static method which bounces an axis-aligned body traveling along the
+     * given velocity off of every wall it hits. The contact with each wall
+     * gives the normal to reflect the velocity about, normalizing it after,
+     * and how far the body is inside the wall, which it is pushed back out
+     * by. A body that is already moving away from a wall is only pushed out,
+     * which does not count as a bounce, so a body is never bounced twice by
+     * the same wall. This is the wall collision step of move, shared with
+     * ProjectileStore.
+     * @param body is the ImageObject being bounced, at its current position,
+     * which is moved out of the walls.
+     * @param vx is the x velocity of the body, which is updated.
+     * @param vy is the y velocity of the body, which is updated.
+     * @param walls is the vector of Walls to check for collisions.
+     * @param grid is the WallGrid built from the vector of Walls.
+     * @return an int representing the number of walls the body bounced off of.
+     */
+    static int bounceOffWalls(ImageObject& body, double& vx, double& vy,
+            const std::vector<ImageObject>& walls, const WallGrid& grid) noexcept;
+
 private:
 
     /** An int representing the number of collisions of this Projectile. */
@@ -0,0 +1,430 @@
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#include <algorithm>
+#include <cmath>
+#include "ProjectileStore.h"
+
+using namespace std;
+using namespace deflection;
+
+constexpr ProjectileHandle ProjectileStore::INVALID_HANDLE;
+
+ProjectileStore::ProjectileStore(unsigned int imageIndex, double sideLength,
+        unsigned int capacity)
+: imageIndex_(imageIndex), sideLength_(sideLength), capacity_(capacity),
+slotIndices_(capacity), slotGenerations_(capacity) {
+
+    // Allocate everything up front, so that adding never reallocates
+    x_.reserve(capacity);
+    y_.reserve(capacity);
+    prevX_.reserve(capacity);
+    prevY_.reserve(capacity);
+    vx_.reserve(capacity);
+    vy_.reserve(capacity);
+    numCollisions_.reserve(capacity);
+    slots_.reserve(capacity);
+    chunkHits_.reserve((capacity + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE);
+
+    // Every slot is free, with the lowest slots used first
+    freeSlots_.reserve(capacity);
+    for (unsigned int slot = capacity; slot > 0; slot -= 1) {
+        freeSlots_.push_back(slot - 1);
+    }
+}
+
+unsigned int ProjectileStore::size() const noexcept {
+    return x_.size();
+}
+
+unsigned int ProjectileStore::capacity() const noexcept {
+    return capacity_;
+}
+
+ProjectileHandle ProjectileStore::add(const Projectile& p) noexcept {
+    if (freeSlots_.empty()) {
+        return INVALID_HANDLE;
+    }
+    unsigned int slot = freeSlots_.back();
+    freeSlots_.pop_back();
+    slotIndices_[slot] = size();
+    slots_.push_back(slot);
+
+    x_.push_back(p.getCenterX());
+    y_.push_back(p.getCenterY());
+    prevX_.push_back(p.getCenterX());
+    prevY_.push_back(p.getCenterY());
+    vx_.push_back(p.getVelocityX());
+    vy_.push_back(p.getVelocityY());
+    numCollisions_.push_back(p.getNumCollisions());
+    return {slot, slotGenerations_[slot]};
+}
+
+int ProjectileStore::indexOf(ProjectileHandle handle) const noexcept {
+    if (handle.slot >= capacity_ || slotGenerations_[handle.slot] != handle.generation
+            || slotIndices_[handle.slot] >= size() || slots_[slotIndices_[handle.slot]] != handle.slot) {
+        return -1;
+    }
+    return slotIndices_[handle.slot];
+}
+
+bool ProjectileStore::remove(ProjectileHandle handle) noexcept {
+    int i = indexOf(handle);
+    if (i < 0) {
+        return false;
+    }
+    removeAt(i);
+    return true;
+}
+
+void ProjectileStore::clear() noexcept {
+    for (unsigned int slot : slots_) {
+        slotGenerations_[slot] += 1;
+        freeSlots_.push_back(slot);
+    }
+    slots_.clear();
+    x_.clear();
+    y_.clear();
+    prevX_.clear();
+    prevY_.clear();
+    vx_.clear();
+    vy_.clear();
+    numCollisions_.clear();
+}
+
+ImageObject ProjectileStore::getImage(unsigned int i, double alpha) const noexcept {
+    return ImageObject(imageIndex_, prevX_[i] + (x_[i] - prevX_[i]) * alpha,
+            prevY_[i] + (y_[i] - prevY_[i]) * alpha, sideLength_, sideLength_, 0.0);
+}
+
+double ProjectileStore::getCenterX(unsigned int i) const noexcept {
+    return x_[i];
+}
+
+double ProjectileStore::getCenterY(unsigned int i) const noexcept {
+    return y_[i];
+}
+
+double ProjectileStore::getPrevCenterX(unsigned int i) const noexcept {
+    return prevX_[i];
+}
+
+double ProjectileStore::getPrevCenterY(unsigned int i) const noexcept {
+    return prevY_[i];
+}
+
+ProjectileHandle ProjectileStore::getHandle(unsigned int i) const noexcept {
+    return {slots_[i], slotGenerations_[slots_[i]]};
+}
+
+int ProjectileStore::getNumCollisions(unsigned int i) const noexcept {
+    return numCollisions_[i];
+}
+
+int ProjectileStore::move(double delta, const vector<ImageObject>& walls, const WallGrid& grid,
+        unsigned int screenWidth, unsigned int screenHeight,
+        const ImageObject& target, unsigned int maxCollisions, ThreadPool* pool) noexcept {
+    MoveArguments arguments = {delta, &walls, &grid, screenWidth, screenHeight, &target,
+        (int) maxCollisions};
+    if (pool == nullptr || pool->getNumThreads() == 1 || size() < PARALLEL_THRESHOLD) {
+        return step(0, size(), arguments);
+    }
+
+    // Every projectile moves independently of the others, so chunks of them
+    // are moved in parallel. The first hit of the whole store is the first
+    // hit of the first chunk with one, whatever order the chunks ran in.
+    unsigned int numChunks = (size() + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE;
+    chunkHits_.resize(numChunks);
+    pool->parallelFor(size(), PARALLEL_CHUNK_SIZE,
+            [this, &arguments](unsigned int chunk, unsigned int begin, unsigned int end) {
+                chunkHits_[chunk] = step(begin, end, arguments);
+            });
+    for (int hit : chunkHits_) {
+        if (hit >= 0) {
+            return hit;
+        }
+    }
+    return -1;
+}
+
+int ProjectileStore::step(unsigned int begin, unsigned int end,
+        const MoveArguments& arguments) noexcept {
+
+    // Keep the positions before moving
+    copy(x_.begin() + begin, x_.begin() + end, prevX_.begin() + begin);
+    copy(y_.begin() + begin, y_.begin() + end, prevY_.begin() + begin);
+
+    // Bounce against screen edges
+    bounceOffEdges(begin, end, arguments.screenWidth, arguments.screenHeight);
+
+    // Bounce against walls, one projectile at a time, reusing a single body
+    // that is moved to each projectile in turn and pushed out of the walls
+    ImageObject body(imageIndex_, 0.0, 0.0, sideLength_, sideLength_, 0.0);
+    for (unsigned int i = begin; i < end; i += 1) {
+        body.setCenter(x_[i], y_[i]);
+        numCollisions_[i] += Projectile::bounceOffWalls(body, vx_[i], vy_[i],
+                *arguments.walls, *arguments.grid);
+        x_[i] = body.getCenterX();
+        y_[i] = body.getCenterY();
+    }
+
+    // Update positions, checking for the target at the same time
+    return integrate(begin, end, arguments.delta, *arguments.target, body, arguments.maxCollisions);
+}
+
+void ProjectileStore::removeExpired(unsigned int maxCollisions) noexcept {
+    // The projectile moved into the place of a removed one is checked next,
+    // so the index only advances past projectiles that are kept
+    unsigned int i = 0;
+    while (i < size()) {
+        if (numCollisions_[i] > (int) maxCollisions) {
+            removeAt(i);
+        } else {
+            i += 1;
+        }
+    }
+}
+
+void ProjectileStore::removeAt(unsigned int i) noexcept {
+    // Free the slot, changing its generation so its handles become stale
+    unsigned int slot = slots_[i];
+    slotGenerations_[slot] += 1;
+    freeSlots_.push_back(slot);
+
+    // Move the last projectile into the place of the removed one
+    unsigned int last = size() - 1;
+    if (i != last) {
+        x_[i] = x_[last];
+        y_[i] = y_[last];
+        prevX_[i] = prevX_[last];
+        prevY_[i] = prevY_[last];
+        vx_[i] = vx_[last];
+        vy_[i] = vy_[last];
+        numCollisions_[i] = numCollisions_[last];
+        slots_[i] = slots_[last];
+        slotIndices_[slots_[i]] = i;
+    }
+    x_.pop_back();
+    y_.pop_back();
+    prevX_.pop_back();
+    prevY_.pop_back();
+    vx_.pop_back();
+    vy_.pop_back();
+    numCollisions_.pop_back();
+    slots_.pop_back();
+}
+
+void ProjectileStore::bounceOffEdges(unsigned int begin, unsigned int end,
+        unsigned int screenWidth, unsigned int screenHeight) noexcept {
+    double half = sideLength_ / 2.0;
+    double right = screenWidth - half;
+    double bottom = screenHeight - half;
+    unsigned int i = begin;
+
+    // Each check is done as a compare that yields a mask, and the reflected
+    // position and negated velocity are blended in where the mask is set. The
+    // checks are done in the same order as the scalar code below, so the
+    // results are identical.
+#if defined(__AVX2__)
+    const __m256d low = _mm256_set1_pd(half);
+    const __m256d twiceLow = _mm256_set1_pd(2 * half);
+    const __m256d highX = _mm256_set1_pd(right);
+    const __m256d twiceHighX = _mm256_set1_pd(2 * right);
+    const __m256d highY = _mm256_set1_pd(bottom);
+    const __m256d twiceHighY = _mm256_set1_pd(2 * bottom);
+    const __m256d signBit = _mm256_set1_pd(-0.0);
+    const __m256d one = _mm256_set1_pd(1.0);
+    for (; i + 4 <= end; i += 4) {
+        __m256d x = _mm256_loadu_pd(&x_[i]);
+        __m256d y = _mm256_loadu_pd(&y_[i]);
+        __m256d vx = _mm256_loadu_pd(&vx_[i]);
+        __m256d vy = _mm256_loadu_pd(&vy_[i]);
+        __m256d hits = _mm256_setzero_pd();
+
+        __m256d m = _mm256_cmp_pd(x, low, _CMP_LT_OQ);
+        x = _mm256_blendv_pd(x, _mm256_sub_pd(twiceLow, x), m);
+        vx = _mm256_xor_pd(vx, _mm256_and_pd(m, signBit));
+        hits = _mm256_add_pd(hits, _mm256_and_pd(m, one));
+
+        m = _mm256_cmp_pd(y, low, _CMP_LT_OQ);
+        y = _mm256_blendv_pd(y, _mm256_sub_pd(twiceLow, y), m);
+        vy = _mm256_xor_pd(vy, _mm256_and_pd(m, signBit));
+        hits = _mm256_add_pd(hits, _mm256_and_pd(m, one));
+
+        m = _mm256_cmp_pd(x, highX, _CMP_GT_OQ);
+        x = _mm256_blendv_pd(x, _mm256_sub_pd(twiceHighX, x), m);
+        vx = _mm256_xor_pd(vx, _mm256_and_pd(m, signBit));
+        hits = _mm256_add_pd(hits, _mm256_and_pd(m, one));
+
+        m = _mm256_cmp_pd(y, highY, _CMP_GT_OQ);
+        y = _mm256_blendv_pd(y, _mm256_sub_pd(twiceHighY, y), m);
+        vy = _mm256_xor_pd(vy, _mm256_and_pd(m, signBit));
+        hits = _mm256_add_pd(hits, _mm256_and_pd(m, one));
+
+        _mm256_storeu_pd(&x_[i], x);
+        _mm256_storeu_pd(&y_[i], y);
+        _mm256_storeu_pd(&vx_[i], vx);
+        _mm256_storeu_pd(&vy_[i], vy);
+        __m128i counts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&numCollisions_[i]));
+        counts = _mm_add_epi32(counts, _mm256_cvtpd_epi32(hits));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&numCollisions_[i]), counts);
+    }
+#elif defined(__SSE2__)
+    const __m128d low = _mm_set1_pd(half);
+    const __m128d twiceLow = _mm_set1_pd(2 * half);
+    const __m128d highX = _mm_set1_pd(right);
+    const __m128d twiceHighX = _mm_set1_pd(2 * right);
+    const __m128d highY = _mm_set1_pd(bottom);
+    const __m128d twiceHighY = _mm_set1_pd(2 * bottom);
+    const __m128d signBit = _mm_set1_pd(-0.0);
+    const __m128d one = _mm_set1_pd(1.0);
+    for (; i + 2 <= end; i += 2) {
+        __m128d x = _mm_loadu_pd(&x_[i]);
+        __m128d y = _mm_loadu_pd(&y_[i]);
+        __m128d vx = _mm_loadu_pd(&vx_[i]);
+        __m128d vy = _mm_loadu_pd(&vy_[i]);
+        __m128d hits = _mm_setzero_pd();
+
+        // SSE2 has no blend, so select with and, andnot and or
+        __m128d m = _mm_cmplt_pd(x, low);
+        x = _mm_or_pd(_mm_and_pd(m, _mm_sub_pd(twiceLow, x)), _mm_andnot_pd(m, x));
+        vx = _mm_xor_pd(vx, _mm_and_pd(m, signBit));
+        hits = _mm_add_pd(hits, _mm_and_pd(m, one));
+
+        m = _mm_cmplt_pd(y, low);
+        y = _mm_or_pd(_mm_and_pd(m, _mm_sub_pd(twiceLow, y)), _mm_andnot_pd(m, y));
+        vy = _mm_xor_pd(vy, _mm_and_pd(m, signBit));
+        hits = _mm_add_pd(hits, _mm_and_pd(m, one));
+
+        m = _mm_cmpgt_pd(x, highX);
+        x = _mm_or_pd(_mm_and_pd(m, _mm_sub_pd(twiceHighX, x)), _mm_andnot_pd(m, x));
+        vx = _mm_xor_pd(vx, _mm_and_pd(m, signBit));
+        hits = _mm_add_pd(hits, _mm_and_pd(m, one));
+
+        m = _mm_cmpgt_pd(y, highY);
+        y = _mm_or_pd(_mm_and_pd(m, _mm_sub_pd(twiceHighY, y)), _mm_andnot_pd(m, y));
+        vy = _mm_xor_pd(vy, _mm_and_pd(m, signBit));
+        hits = _mm_add_pd(hits, _mm_and_pd(m, one));
+
+        _mm_storeu_pd(&x_[i], x);
+        _mm_storeu_pd(&y_[i], y);
+        _mm_storeu_pd(&vx_[i], vx);
+        _mm_storeu_pd(&vy_[i], vy);
+        __m128i counts = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&numCollisions_[i]));
+        counts = _mm_add_epi32(counts, _mm_cvtpd_epi32(hits));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&numCollisions_[i]), counts);
+    }
+#endif
+
+    // The remaining projectiles, or all of them without SIMD
+    for (; i < end; i += 1) {
+        if (x_[i] < half) {
+            x_[i] = 2 * half - x_[i];
+            vx_[i] = -vx_[i];
+            numCollisions_[i] += 1;
+        }
+        if (y_[i] < half) {
+            y_[i] = 2 * half - y_[i];
+            vy_[i] = -vy_[i];
+            numCollisions_[i] += 1;
+        }
+        if (x_[i] > right) {
+            x_[i] = 2 * right - x_[i];
+            vx_[i] = -vx_[i];
+            numCollisions_[i] += 1;
+        }
+        if (y_[i] > bottom) {
+            y_[i] = 2 * bottom - y_[i];
+            vy_[i] = -vy_[i];
+            numCollisions_[i] += 1;
+        }
+    }
+}
+
+int ProjectileStore::integrate(unsigned int begin, unsigned int end, double delta,
+        const ImageObject& target, ImageObject& body, int maxCollisions) noexcept {
+
+    // A projectile can only hit the target if their bounding circles touch,
+    // which is checked for every projectile as it is moved. Only those that
+    // pass are checked with SAT, and none are once one hits.
+    double radius = (sideLength_ * sqrt(2.0) + hypot(target.getWidth(), target.getLength())) / 2.0;
+    double reach = radius * radius * (1.0 + 1e-9);
+    double targetX = target.getCenterX();
+    double targetY = target.getCenterY();
+    int hit = -1;
+    unsigned int i = begin;
+#if defined(__AVX2__)
+    const __m256d d = _mm256_set1_pd(delta);
+    const __m256d tx = _mm256_set1_pd(targetX);
+    const __m256d ty = _mm256_set1_pd(targetY);
+    const __m256d r = _mm256_set1_pd(reach);
+    for (; i + 4 <= end; i += 4) {
+        __m256d x = _mm256_add_pd(_mm256_loadu_pd(&x_[i]), _mm256_mul_pd(d, _mm256_loadu_pd(&vx_[i])));
+        __m256d y = _mm256_add_pd(_mm256_loadu_pd(&y_[i]), _mm256_mul_pd(d, _mm256_loadu_pd(&vy_[i])));
+        _mm256_storeu_pd(&x_[i], x);
+        _mm256_storeu_pd(&y_[i], y);
+        if (hit < 0) {
+            __m256d dx = _mm256_sub_pd(x, tx);
+            __m256d dy = _mm256_sub_pd(y, ty);
+            __m256d d2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+            int candidates = _mm256_movemask_pd(_mm256_cmp_pd(d2, r, _CMP_LE_OQ));
+            for (; candidates != 0; candidates &= candidates - 1) {
+                unsigned int lane = i + __builtin_ctz(candidates);
+                if (hitsTarget(lane, target, body, maxCollisions)) {
+                    hit = lane;
+                    break;
+                }
+            }
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128d d = _mm_set1_pd(delta);
+    const __m128d tx = _mm_set1_pd(targetX);
+    const __m128d ty = _mm_set1_pd(targetY);
+    const __m128d r = _mm_set1_pd(reach);
+    for (; i + 2 <= end; i += 2) {
+        __m128d x = _mm_add_pd(_mm_loadu_pd(&x_[i]), _mm_mul_pd(d, _mm_loadu_pd(&vx_[i])));
+        __m128d y = _mm_add_pd(_mm_loadu_pd(&y_[i]), _mm_mul_pd(d, _mm_loadu_pd(&vy_[i])));
+        _mm_storeu_pd(&x_[i], x);
+        _mm_storeu_pd(&y_[i], y);
+        if (hit < 0) {
+            __m128d dx = _mm_sub_pd(x, tx);
+            __m128d dy = _mm_sub_pd(y, ty);
+            __m128d d2 = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+            int candidates = _mm_movemask_pd(_mm_cmple_pd(d2, r));
+            for (; candidates != 0; candidates &= candidates - 1) {
+                unsigned int lane = i + __builtin_ctz(candidates);
+                if (hitsTarget(lane, target, body, maxCollisions)) {
+                    hit = lane;
+                    break;
+                }
+            }
+        }
+    }
+#endif
+
+    // The remaining projectiles, or all of them without SIMD
+    for (; i < end; i += 1) {
+        x_[i] += delta * vx_[i];
+        y_[i] += delta * vy_[i];
+        if (hit < 0) {
+            double dx = x_[i] - targetX;
+            double dy = y_[i] - targetY;
+            if (dx * dx + dy * dy <= reach && hitsTarget(i, target, body, maxCollisions)) {
+                hit = i;
+            }
+        }
+    }
+    return hit;
+}
+
+bool ProjectileStore::hitsTarget(unsigned int i, const ImageObject& target, ImageObject& body,
+        int maxCollisions) const noexcept {
+    // Projectiles that have bounced too often are about to be removed, and
+    // cannot win
+    if (numCollisions_[i] > maxCollisions) {
+        return false;
+    }
+    body.setCenter(x_[i], y_[i]);
+    return body.hits<AxisAligned, AxisAligned>(target);
+}
@@ -0,0 +1,360 @@
+#ifndef PROJECTILESTORE_H
+#define PROJECTILESTORE_H
+
+#include <vector>
+#include "Projectile.h"
+#include "ThreadPool.h"
+
+namespace deflection {
+
+/**
+ * Refers to a projectile in a ProjectileStore. A handle stays valid while its
+ * projectile is in the store, whatever projectiles are added or removed around
+ * it, and is known to be stale once its projectile is removed, even if its
+ * slot has been reused since.
+ */
+struct ProjectileHandle {
+
+    /** The slot of the projectile. */
+    unsigned int slot;
+
+    /** The generation of the slot when the projectile was added. */
+    unsigned int generation;
+};
+
+/**
+ * A projectile reaching the target of a game.
+ */
+struct HitEvent {
+
+    /** The handle of the projectile. */
+    ProjectileHandle projectile;
+
+    /** The tick of the game on which the projectile reached the target. */
+    unsigned long long tick;
+
+    /** The number of times the projectile had bounced. */
+    int bounces;
+};
+
+/**
+ * Stores the projectiles of a game as a structure of arrays, with the
+ * positions, velocities and numbers of collisions each kept in their own
+ * contiguous array. All the projectiles in a store share one image and one
+ * size, so those are kept once. Bouncing off the screen edges and updating
+ * positions are done for many projectiles at once with SIMD instructions when
+ * the compiler targets AVX2 or SSE2, and one at a time otherwise.
+ *
+ * The store is a pool with a fixed capacity, allocated when it is constructed,
+ * so adding never reallocates. Projectiles are removed by moving the last one
+ * into their place, and are referred to from outside by ProjectileHandles,
+ * whose slots are recycled through a free list.
+ *
+ * @author Trevor Day
+ */
+class ProjectileStore {
+public:
+
+    /**
+     * Constructs a new, empty ProjectileStore.
+     * @param imageIndex is an unsigned int representing the index of the image
+     * loaded in SDL that should be used when rendering the projectiles.
+     * @param sideLength is the length of the sides of the projectile squares.
+     * @param capacity is the most projectiles the store can hold.
+     */
+    ProjectileStore(unsigned int imageIndex, double sideLength,
+            unsigned int capacity = DEFAULT_CAPACITY);
+
+    /** The capacity of a ProjectileStore unless another is given. */
+    static constexpr unsigned int DEFAULT_CAPACITY = 65536;
+
+    /** A handle that never refers to a projectile. */
+    static constexpr ProjectileHandle INVALID_HANDLE = {~0u, 0};
+
+    /**
+     * Returns the number of projectiles in this store.
+     * @return an unsigned int representing the number of projectiles.
+     */
+    unsigned int size() const noexcept;
+
+    /**
+     * Returns the most projectiles this store can hold.
+     * @return an unsigned int representing the capacity.
+     */
+    unsigned int capacity() const noexcept;
+
+    /**
+     * Adds the position and velocity of the given Projectile to this store,
+     * unless the store is full.
+     * @param p is the Projectile to add.
+     * @return the handle of the projectile, or INVALID_HANDLE if the store is
+     * full.
+     */
+    ProjectileHandle add(const Projectile& p) noexcept;
+
+    /**
+     * Returns the index of the projectile with the given handle. Indices
+     * change as projectiles are removed, so they should not be kept.
+     * @param handle is the handle of the projectile.
+     * @return the index of the projectile, or -1 if it is no longer in the
+     * store.
+     */
+    int indexOf(ProjectileHandle handle) const noexcept;
+
+    /**
+     * Removes the projectile with the given handle, moving the last projectile
+     * into its place.
+     * @param handle is the handle of the projectile.
+     * @return true if the projectile was removed, false if it was no longer in
+     * the store.
+     */
+    bool remove(ProjectileHandle handle) noexcept;
+
+    /**
+     * Removes every projectile from this store.
+     */
+    void clear() noexcept;
+
+    /**
+     * Returns the projectile at the given index as an ImageObject, so that it
+     * can be drawn or checked for collision.
+     * @param i is the index of the projectile.
+     * @param alpha is how far between its position before the last move and
+     * its current position the projectile should be placed, from 0 to 1.
+     * @return an ImageObject at the position of the projectile.
+     */
+    ImageObject getImage(unsigned int i, double alpha = 1.0) const noexcept;
+
+    /**
+     * Returns the x coordinate of the center of the projectile at the given
+     * index.
+     * @param i is the index of the projectile.
+     * @return a double representing the center x coordinate.
+     */
+    double getCenterX(unsigned int i) const noexcept;
+
+    /**
+     * Returns the y coordinate of the center of the projectile at the given
+     * index.
+     * @param i is the index of the projectile.
+     * @return a double representing the center y coordinate.
+     */
+    double getCenterY(unsigned int i) const noexcept;
+
+    /**
+     * Returns the x coordinate of the center of the projectile at the given
+     * index before the last move.
+     * @param i is the index of the projectile.
+     * @return a double representing the previous center x coordinate.
+     */
+    double getPrevCenterX(unsigned int i) const noexcept;
+
+    /**
+     * Returns the y coordinate of the center of the projectile at the given
+     * index before the last move.
+     * @param i is the index of the projectile.
+     * @return a double representing the previous center y coordinate.
+     */
+    double getPrevCenterY(unsigned int i) const noexcept;
+
+    /**
+     * Returns the handle of the projectile at the given index.
+     * @param i is the index of the projectile.
+     * @return the ProjectileHandle of the projectile.
+     */
+    ProjectileHandle getHandle(unsigned int i) const noexcept;
+
+    /**
+     * Returns the number of collisions of the projectile at the given index.
+     * @param i is the index of the projectile.
+     * @return an int representing the number of collisions.
+     */
+    int getNumCollisions(unsigned int i) const noexcept;
+
+    /**
+     * Moves every projectile according to the given delta, with the same
+     * rules as Projectile::move: first bouncing off the screen edges, then off
+     * of walls, and finally updating the position. The positions before
+     * moving are kept, for drawing between the two.
+     *
+     * While the positions are updated, the projectiles are also checked
+     * against the target, first by their bounding circles and then, for the
+     * few that are close, with SAT. Checking stops at the first projectile
+     * that hits the target.
+     *
+     * Given a ThreadPool and at least PARALLEL_THRESHOLD projectiles, chunks
+     * of PARALLEL_CHUNK_SIZE projectiles are moved in parallel. The results
+     * are the same as moving them serially.
+     * @param delta is the delta of time to move the projectiles by.
+     * @param walls is the vector of Walls to check for collisions.
+     * @param grid is the WallGrid built from the vector of Walls.
+     * @param screenWidth is the width of the screen.
+     * @param screenHeight is the height of the screen.
+     * @param target is the target to check the projectiles against.
+     * @param maxCollisions is the number of collisions a projectile may have
+     * and still hit the target; projectiles with more are about to expire.
+     * @param pool is the ThreadPool to move the projectiles with, or null to
+     * move them on the calling thread.
+     * @return the index of the first projectile that hits the target after
+     * moving, or -1 if none does.
+     */
+    int move(double delta, const std::vector<ImageObject>& walls, const WallGrid& grid,
+            unsigned int screenWidth, unsigned int screenHeight,
+            const ImageObject& target, unsigned int maxCollisions,
+            ThreadPool* pool = nullptr) noexcept;
+
+    /**
+     * The fewest projectiles moved in parallel. Below this, waking the
+     * threads costs more than it saves.
+     */
+    static constexpr unsigned int PARALLEL_THRESHOLD = 4096;
+
+    /** The number of projectiles in each chunk moved in parallel. */
+    static constexpr unsigned int PARALLEL_CHUNK_SIZE = 1024;
+
+    /**
+     * Removes every projectile with more than the given number of collisions.
+     * Each is replaced by the last projectile, so the order of the remaining
+     * projectiles changes.
+     * @param maxCollisions is the number of collisions a projectile may have.
+     */
+    void removeExpired(unsigned int maxCollisions) noexcept;
+
+private:
+
+    /**
+     * The arguments of move, passed on to each chunk.
+     */
+    struct MoveArguments {
+        /** The delta of time to move the projectiles by. */
+        double delta;
+
+        /** The walls to check for collisions. */
+        const std::vector<ImageObject>* walls;
+
+        /** The WallGrid built from the walls. */
+        const WallGrid* grid;
+
+        /** The width of the screen. */
+        unsigned int screenWidth;
+
+        /** The height of the screen. */
+        unsigned int screenHeight;
+
+        /** The target to check the projectiles against. */
+        const ImageObject* target;
+
+        /** The number of collisions a projectile may have and still hit the target. */
+        int maxCollisions;
+    };
+
+    /**
+     * Moves the projectiles in the range, as move does for all of them.
+     * @param begin is the index of the first projectile.
+     * @param end is one past the index of the last projectile.
+     * @param arguments are the arguments of move.
+     * @return the index of the first projectile in the range that hits the
+     * target, or -1 if none does.
+     */
+    int step(unsigned int begin, unsigned int end, const MoveArguments& arguments) noexcept;
+
+    /**
+     * Removes the projectile at the given index, moving the last projectile
+     * into its place and freeing its slot.
+     * @param i is the index of the projectile.
+     */
+    void removeAt(unsigned int i) noexcept;
+
+    /**
+     * Bounces the projectiles in the range off of the screen edges, reflecting
+     * their positions and velocities and counting the collisions.
+     * @param begin is the index of the first projectile.
+     * @param end is one past the index of the last projectile.
+     * @param screenWidth is the width of the screen.
+     * @param screenHeight is the height of the screen.
+     */
+    void bounceOffEdges(unsigned int begin, unsigned int end,
+            unsigned int screenWidth, unsigned int screenHeight) noexcept;
+
+    /**
+     * Updates the positions of the projectiles in the range by their
+     * velocities, and finds the first that hits the target at its new
+     * position.
+     * @param begin is the index of the first projectile.
+     * @param end is one past the index of the last projectile.
+     * @param delta is the delta of time to move the projectiles by.
+     * @param target is the target to check the projectiles against.
+     * @param body is an ImageObject the size of a projectile, moved to each
+     * projectile that is checked with SAT.
+     * @param maxCollisions is the number of collisions a projectile may have
+     * and still hit the target.
+     * @return the index of the first projectile that hits the target, or -1
+     * if none does.
+     */
+    int integrate(unsigned int begin, unsigned int end, double delta,
+            const ImageObject& target, ImageObject& body, int maxCollisions) noexcept;
+
+    /**
+     * Returns whether the projectile at the given index hits the target, once
+     * its bounding circle is known to touch that of the target.
+     * @param i is the index of the projectile.
+     * @param target is the target to check the projectile against.
+     * @param body is an ImageObject the size of a projectile.
+     * @param maxCollisions is the number of collisions a projectile may have
+     * and still hit the target.
+     * @return true if the projectile hits the target.
+     */
+    bool hitsTarget(unsigned int i, const ImageObject& target, ImageObject& body,
+            int maxCollisions) const noexcept;
+
+    /** The index of the image of the projectiles loaded in SDL. */
+    unsigned int imageIndex_;
+
+    /** The length of the sides of the projectiles. */
+    double sideLength_;
+
+    /** The x coordinates of the centers of the projectiles. */
+    std::vector<double> x_;
+
+    /** The y coordinates of the centers of the projectiles. */
+    std::vector<double> y_;
+
+    /** The x coordinates of the centers of the projectiles before the last move. */
+    std::vector<double> prevX_;
+
+    /** The y coordinates of the centers of the projectiles before the last move. */
+    std::vector<double> prevY_;
+
+    /** The x velocities of the projectiles. */
+    std::vector<double> vx_;
+
+    /** The y velocities of the projectiles. */
+    std::vector<double> vy_;
+
+    /** The numbers of collisions of the projectiles. */
+    std::vector<int> numCollisions_;
+
+    /** The most projectiles the store can hold. */
+    unsigned int capacity_;
+
+    /** The slots of the projectiles, by index. */
+    std::vector<unsigned int> slots_;
+
+    /** The index of the projectile in each slot that is in use. */
+    std::vector<unsigned int> slotIndices_;
+
+    /**
+     * The generation of each slot, which changes each time the projectile in
+     * it is removed.
+     */
+    std::vector<unsigned int> slotGenerations_;
+
+    /** The slots that are not in use, the next to be used last. */
+    std::vector<unsigned int> freeSlots_;
+
+    /** The first hit of each chunk of a parallel move. */
+    std::vector<int> chunkHits_;
+};
+}
+
+#endif /* PROJECTILESTORE_H */
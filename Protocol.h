@@ -0,0 +1,216 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Messages are copied straight into these structs, so the host must use the
+// byte order of the wire
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Messages are copied in place and need a little endian host"
+#endif
+
+namespace deflection {
+
+/**
+ * The header of every message between the server and its clients. Like an
+ * input log, messages are sent little endian in exactly the layout of these
+ * structs, which is checked below, with the body of a message following its
+ * header.
+ */
+struct MessageHeader {
+
+    /** The kind of message, one of the MSG constants. */
+    std::uint16_t type;
+
+    /** Unused, always 0. */
+    std::uint16_t reserved;
+
+    /** The number of bytes of the body after the header. */
+    std::uint32_t length;
+
+    /** The room the message is about. */
+    std::uint32_t room;
+};
+
+static_assert(sizeof(MessageHeader) == 12, "MessageHeader must match the wire format");
+static_assert(offsetof(MessageHeader, reserved) == 2, "MessageHeader must match the wire format");
+static_assert(offsetof(MessageHeader, length) == 4, "MessageHeader must match the wire format");
+static_assert(offsetof(MessageHeader, room) == 8, "MessageHeader must match the wire format");
+
+/**
+ * The body of a MSG_FIRE, asking the player of a room to fire.
+ */
+struct FireMessage {
+
+    /** The x coordinate to fire towards. */
+    std::int16_t x;
+
+    /** The y coordinate to fire towards. */
+    std::int16_t y;
+
+    /**
+     * A number chosen by the client, not 0, echoed in the first MSG_STATE of
+     * the room after the shot if it is the first shot queued for the room
+     * since the MSG_STATE before, so that the client can time the round trip.
+     */
+    std::uint32_t tag;
+};
+
+static_assert(sizeof(FireMessage) == 8, "FireMessage must match the wire format");
+static_assert(offsetof(FireMessage, y) == 2, "FireMessage must match the wire format");
+static_assert(offsetof(FireMessage, tag) == 4, "FireMessage must match the wire format");
+
+/**
+ * The body of a MSG_LEVEL, describing the level a room is playing. It is
+ * followed by numWalls LevelWalls.
+ */
+struct LevelMessage {
+
+    /** The number of ticks the room had run when the level started. */
+    std::uint32_t tick;
+
+    /** The x coordinate of the center of the player. */
+    std::int16_t playerX;
+
+    /** The y coordinate of the center of the player. */
+    std::int16_t playerY;
+
+    /** The length of the sides of the player. */
+    std::int16_t playerSize;
+
+    /** The x coordinate of the center of the target. */
+    std::int16_t targetX;
+
+    /** The y coordinate of the center of the target. */
+    std::int16_t targetY;
+
+    /** The width of the target. */
+    std::int16_t targetWidth;
+
+    /** The length of the target. */
+    std::int16_t targetLength;
+
+    /** The number of walls following. */
+    std::uint16_t numWalls;
+};
+
+static_assert(sizeof(LevelMessage) == 20, "LevelMessage must match the wire format");
+static_assert(offsetof(LevelMessage, playerX) == 4, "LevelMessage must match the wire format");
+static_assert(offsetof(LevelMessage, playerY) == 6, "LevelMessage must match the wire format");
+static_assert(offsetof(LevelMessage, playerSize) == 8, "LevelMessage must match the wire format");
+static_assert(offsetof(LevelMessage, targetX) == 10, "LevelMessage must match the wire format");
+static_assert(offsetof(LevelMessage, targetY) == 12, "LevelMessage must match the wire format");
+static_assert(offsetof(LevelMessage, targetWidth) == 14, "LevelMessage must match the wire format");
+static_assert(offsetof(LevelMessage, targetLength) == 16, "LevelMessage must match the wire format");
+static_assert(offsetof(LevelMessage, numWalls) == 18, "LevelMessage must match the wire format");
+
+/**
+ * A wall of a MSG_LEVEL.
+ */
+struct LevelWall {
+
+    /** The x coordinate of the center of the wall. */
+    std::int16_t x;
+
+    /** The y coordinate of the center of the wall. */
+    std::int16_t y;
+
+    /** The width of the wall. */
+    std::int16_t width;
+
+    /** The length of the wall. */
+    std::int16_t length;
+
+    /** The angle of the wall, in degrees. */
+    std::int16_t angle;
+};
+
+static_assert(sizeof(LevelWall) == 10, "LevelWall must match the wire format");
+static_assert(offsetof(LevelWall, y) == 2, "LevelWall must match the wire format");
+static_assert(offsetof(LevelWall, width) == 4, "LevelWall must match the wire format");
+static_assert(offsetof(LevelWall, length) == 6, "LevelWall must match the wire format");
+static_assert(offsetof(LevelWall, angle) == 8, "LevelWall must match the wire format");
+
+/**
+ * The body of a MSG_STATE, the state of a room after a tick. It is followed
+ * by numProjectiles StateProjectiles.
+ */
+struct StateMessage {
+
+    /** The number of ticks the room has run. */
+    std::uint32_t tick;
+
+    /**
+     * The tag of the first shot queued since the last MSG_STATE, or 0. The
+     * tags of the shots queued after it are not echoed, so that a round trip
+     * timed by the tag includes the whole wait for the state.
+     */
+    std::uint32_t firstTag;
+
+    /** The number of projectiles following. */
+    std::uint16_t numProjectiles;
+
+    /** 1 if a level was won since the last MSG_STATE, otherwise 0. */
+    std::uint8_t won;
+
+    /** Unused, always 0. */
+    std::uint8_t reserved;
+};
+
+static_assert(sizeof(StateMessage) == 12, "StateMessage must match the wire format");
+static_assert(offsetof(StateMessage, firstTag) == 4, "StateMessage must match the wire format");
+static_assert(offsetof(StateMessage, numProjectiles) == 8, "StateMessage must match the wire format");
+static_assert(offsetof(StateMessage, won) == 10, "StateMessage must match the wire format");
+static_assert(offsetof(StateMessage, reserved) == 11, "StateMessage must match the wire format");
+
+/**
+ * A projectile of a MSG_STATE, rounded to the nearest pixel.
+ */
+struct StateProjectile {
+
+    /** The x coordinate of the center of the projectile. */
+    std::int16_t x;
+
+    /** The y coordinate of the center of the projectile. */
+    std::int16_t y;
+};
+
+static_assert(sizeof(StateProjectile) == 4, "StateProjectile must match the wire format");
+static_assert(offsetof(StateProjectile, y) == 2, "StateProjectile must match the wire format");
+
+/** The port the server listens on when it is not given a socket path. */
+constexpr std::uint16_t DEFAULT_PORT = 7878;
+
+/** Sent by a client to receive the level and state of a room. No body. */
+constexpr std::uint16_t MSG_JOIN = 1;
+
+/** Sent by a client to stop receiving a room. No body. */
+constexpr std::uint16_t MSG_LEAVE = 2;
+
+/** Sent by a client to fire in a room. The body is a FireMessage. */
+constexpr std::uint16_t MSG_FIRE = 3;
+
+/** Sent by a client to start a new level in a room. No body. */
+constexpr std::uint16_t MSG_RESTART = 4;
+
+/**
+ * Sent by the server to a client when it joins a room, and to every client in
+ * a room when its level changes. The body is a LevelMessage.
+ */
+constexpr std::uint16_t MSG_LEVEL = 16;
+
+/** Sent by the server after ticks of a room. The body is a StateMessage. */
+constexpr std::uint16_t MSG_STATE = 17;
+
+/**
+ * Sent by the server when a message could not be handled, such as one for a
+ * room that does not exist. No body.
+ */
+constexpr std::uint16_t MSG_ERROR = 18;
+
+/** The longest body the server accepts from a client. */
+constexpr std::uint32_t MAX_CLIENT_BODY = 64;
+}
+
+#endif /* PROTOCOL_H */
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Room.h"
+
+using namespace std;
+using namespace deflection;
+
+/**
+ * Rounds a coordinate to the nearest pixel that fits in a message.
+ * @param value is the coordinate.
+ * @return the rounded coordinate, clamped to the range of an int16_t.
+ */
+static int16_t toPixel(double value) noexcept {
+    return static_cast<int16_t>(max(-32768.0, min(32767.0, round(value))));
+}
+
+/**
+ * Appends a message to the given bytes, with its body still to be written.
+ * @param out is the bytes to append to.
+ * @param type is the kind of message.
+ * @param room is the room the message is about.
+ * @param length is the number of bytes of the body.
+ * @return a pointer to the body, valid until out is next changed.
+ */
+static unsigned char* appendMessage(vector<unsigned char>& out, uint16_t type,
+        uint32_t room, uint32_t length) {
+    size_t start = out.size();
+    out.resize(start + sizeof(MessageHeader) + length);
+    MessageHeader header = {type, 0, length, room};
+    memcpy(out.data() + start, &header, sizeof(header));
+    return out.data() + start + sizeof(header);
+}
+
+Room::Room(uint32_t id, unsigned int screenWidth, unsigned int screenHeight,
+        unsigned int numWalls, unsigned int seed, unsigned int maxProjectiles,
+        bool requireWinnable, double tickSeconds)
+: id_(id), game_(screenWidth, screenHeight, 0, 1, 2, 3, numWalls, seed, maxProjectiles) {
+    // Rooms are ticked across the server's threads, so each moves its own
+    // projectiles and solves its own levels on the thread that ticks it
+    game_.setNumThreads(1);
+    game_.setSolverThreads(1);
+    game_.setTickSeconds(tickSeconds);
+    if (requireWinnable) {
+        game_.setRequireWinnable(true);
+        game_.keepWinnableLevel();
+    }
+}
+
+uint32_t Room::getId() const noexcept {
+    return id_;
+}
+
+bool Room::fire(int16_t x, int16_t y, uint32_t tag) noexcept {
+    if (commands_.size() >= MAX_COMMANDS || atPlayer(x, y)) {
+        return false;
+    }
+    commands_.push_back({MSG_FIRE, x, y});
+    if (firstTag_ == 0) {
+        firstTag_ = tag;
+    }
+    return true;
+}
+
+bool Room::restart() noexcept {
+    if (commands_.size() >= MAX_COMMANDS) {
+        return false;
+    }
+    commands_.push_back({MSG_RESTART, 0, 0});
+    return true;
+}
+
+void Room::tick(double seconds, bool sendState) {
+    output_.clear();
+    levelChanged_ = false;
+    for (const RoomCommand& command : commands_) {
+        // A restart queued before a shot may have moved the player onto it
+        if (command.type == MSG_RESTART) {
+            startLevel();
+        } else if (!atPlayer(command.x, command.y)) {
+            game_.playerFire(command.x, command.y);
+        }
+    }
+    commands_.clear();
+
+    game_.updateState(seconds);
+    if (game_.checkGameWon()) {
+        levelsWon_ += 1;
+        won_ = true;
+        startLevel();
+    }
+
+    if (levelChanged_) {
+        writeLevel(output_);
+    }
+    if (sendState) {
+        writeState();
+    }
+}
+
+const vector<unsigned char>& Room::getOutput() const noexcept {
+    return output_;
+}
+
+bool Room::levelChanged() const noexcept {
+    return levelChanged_;
+}
+
+void Room::writeLevel(vector<unsigned char>& out) const {
+    const vector<ImageObject>& walls = game_.getWalls();
+    uint16_t numWalls = min<size_t>(walls.size(), 65535);
+    unsigned char* body = appendMessage(out, MSG_LEVEL, id_,
+            sizeof(LevelMessage) + numWalls * sizeof(LevelWall));
+
+    const Player& player = game_.getPlayer();
+    const ImageObject& target = game_.getTarget();
+    LevelMessage level;
+    level.tick = static_cast<uint32_t>(levelTick_);
+    level.playerX = toPixel(player.getCenterX());
+    level.playerY = toPixel(player.getCenterY());
+    level.playerSize = toPixel(player.getWidth());
+    level.targetX = toPixel(target.getCenterX());
+    level.targetY = toPixel(target.getCenterY());
+    level.targetWidth = toPixel(target.getWidth());
+    level.targetLength = toPixel(target.getLength());
+    level.numWalls = numWalls;
+    memcpy(body, &level, sizeof(level));
+    body += sizeof(level);
+
+    for (unsigned int i = 0; i < numWalls; i += 1) {
+        LevelWall wall;
+        wall.x = toPixel(walls[i].getCenterX());
+        wall.y = toPixel(walls[i].getCenterY());
+        wall.width = toPixel(walls[i].getWidth());
+        wall.length = toPixel(walls[i].getLength());
+        wall.angle = toPixel(walls[i].getAngle());
+        memcpy(body, &wall, sizeof(wall));
+        body += sizeof(wall);
+    }
+}
+
+unsigned long long Room::getLevelsWon() const noexcept {
+    return levelsWon_;
+}
+
+void Room::startLevel() {
+    game_.startNewGame();
+    levelTick_ = game_.getTick();
+    levelChanged_ = true;
+}
+
+bool Room::atPlayer(int16_t x, int16_t y) const noexcept {
+    const Player& player = game_.getPlayer();
+    return x == toPixel(player.getCenterX()) && y == toPixel(player.getCenterY());
+}
+
+void Room::writeState() {
+    const ProjectileStore& projectiles = game_.getProjectiles();
+    uint16_t numProjectiles = min<unsigned int>(projectiles.size(), 65535);
+    unsigned char* body = appendMessage(output_, MSG_STATE, id_,
+            sizeof(StateMessage) + numProjectiles * sizeof(StateProjectile));
+
+    StateMessage state;
+    state.tick = static_cast<uint32_t>(game_.getTick());
+    state.firstTag = firstTag_;
+    state.numProjectiles = numProjectiles;
+    state.won = won_ ? 1 : 0;
+    state.reserved = 0;
+    memcpy(body, &state, sizeof(state));
+    body += sizeof(state);
+    firstTag_ = 0;
+    won_ = false;
+
+    for (unsigned int i = 0; i < numProjectiles; i += 1) {
+        StateProjectile projectile;
+        projectile.x = toPixel(projectiles.getCenterX(i));
+        projectile.y = toPixel(projectiles.getCenterY(i));
+        memcpy(body, &projectile, sizeof(projectile));
+        body += sizeof(projectile);
+    }
+}
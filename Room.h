@@ -0,0 +1,168 @@
+#ifndef ROOM_H
+#define ROOM_H
+
+#include <cstdint>
+#include <vector>
+#include "ActiveGame.h"
+#include "Protocol.h"
+
+namespace deflection {
+
+/**
+ * A command from a client for a room, waiting for its next tick.
+ */
+struct RoomCommand {
+
+    /** The kind of command, MSG_FIRE or MSG_RESTART. */
+    std::uint16_t type;
+
+    /** The x coordinate to fire towards, for MSG_FIRE. */
+    std::int16_t x;
+
+    /** The y coordinate to fire towards, for MSG_FIRE. */
+    std::int16_t y;
+};
+
+/**
+ * One independent session of the game hosted by the server, with its own
+ * ActiveGame. The server queues the commands of clients for a room between
+ * ticks, and then ticks many rooms at once across a thread pool, so a tick
+ * of a room only touches the room and writes the messages for its clients
+ * into a buffer of its own, which the server sends once every room is done.
+ *
+ * @author Trevor Day
+ */
+class Room {
+public:
+
+    /** The most commands a room takes between two ticks. */
+    static constexpr unsigned int MAX_COMMANDS = 64;
+
+    /**
+     * Constructs a new Room, starting its first level.
+     * @param id is the number of the room.
+     * @param screenWidth is the width of the screen of the game.
+     * @param screenHeight is the height of the screen of the game.
+     * @param numWalls is the number of walls of the levels.
+     * @param seed is the seed of the levels of the room.
+     * @param maxProjectiles is the most projectiles in the room at once.
+     * @param requireWinnable is whether levels must be winnable.
+     * @param tickSeconds is the length of the ticks of the room in seconds.
+     */
+    Room(std::uint32_t id, unsigned int screenWidth, unsigned int screenHeight,
+            unsigned int numWalls, unsigned int seed, unsigned int maxProjectiles,
+            bool requireWinnable, double tickSeconds);
+
+    /**
+     * Returns the number of the room.
+     * @return the id of the room.
+     */
+    std::uint32_t getId() const noexcept;
+
+    /**
+     * Queues a shot of the player, fired at the next tick. A shot towards the
+     * center of the player, as given by MSG_LEVEL, has no direction and is
+     * rejected.
+     * @param x is the x coordinate to fire towards.
+     * @param y is the y coordinate to fire towards.
+     * @param tag is the tag of the shot, echoed in the next MSG_STATE if no
+     * shot was queued since the last one.
+     * @return false if the shot is towards the center of the player or too
+     * many commands are waiting, true otherwise.
+     */
+    bool fire(std::int16_t x, std::int16_t y, std::uint32_t tag) noexcept;
+
+    /**
+     * Queues the start of a new level, at the next tick.
+     * @return false if too many commands are waiting, true otherwise.
+     */
+    bool restart() noexcept;
+
+    /**
+     * Applies the waiting commands and advances the game by one tick,
+     * starting a new level when it is won. The messages for the clients of
+     * the room are written to the output: a MSG_LEVEL if the level changed,
+     * and then a MSG_STATE if one was asked for.
+     * @param seconds is the length of the tick in seconds.
+     * @param sendState is whether to write a MSG_STATE.
+     */
+    void tick(double seconds, bool sendState);
+
+    /**
+     * Returns the messages written by the last tick, to be sent to every
+     * client in the room.
+     * @return a const reference to the bytes of the messages.
+     */
+    const std::vector<unsigned char>& getOutput() const noexcept;
+
+    /**
+     * Returns whether the last tick started a new level, in which case its
+     * output must reach every client, however far behind it is.
+     * @return true if the level changed.
+     */
+    bool levelChanged() const noexcept;
+
+    /**
+     * Appends a MSG_LEVEL describing the current level, as sent to a client
+     * joining the room.
+     * @param out is the bytes to append the message to.
+     */
+    void writeLevel(std::vector<unsigned char>& out) const;
+
+    /**
+     * Returns the number of levels won in the room.
+     * @return the number of levels won.
+     */
+    unsigned long long getLevelsWon() const noexcept;
+
+private:
+
+    /** The number of the room. */
+    std::uint32_t id_;
+
+    /** The game of the room. */
+    ActiveGame game_;
+
+    /** The commands waiting for the next tick. */
+    std::vector<RoomCommand> commands_;
+
+    /** The tag of the first shot queued since the last MSG_STATE, or 0. */
+    std::uint32_t firstTag_ = 0;
+
+    /** Whether a level was won since the last MSG_STATE. */
+    bool won_ = false;
+
+    /** Whether the last tick started a new level. */
+    bool levelChanged_ = false;
+
+    /** The tick the current level started at. */
+    unsigned long long levelTick_ = 0;
+
+    /** The number of levels won. */
+    unsigned long long levelsWon_ = 0;
+
+    /** The messages written by the last tick. */
+    std::vector<unsigned char> output_;
+
+    /**
+     * Starts a new level of the game.
+     */
+    void startLevel();
+
+    /**
+     * Returns whether a shot towards the given coordinates would have no
+     * direction, being at the center of the player rounded as in MSG_LEVEL.
+     * @param x is the x coordinate to fire towards.
+     * @param y is the y coordinate to fire towards.
+     * @return true if the shot is towards the center of the player.
+     */
+    bool atPlayer(std::int16_t x, std::int16_t y) const noexcept;
+
+    /**
+     * Appends a MSG_STATE with the projectiles of the game to the output.
+     */
+    void writeState();
+};
+}
+
+#endif /* ROOM_H */
@@ -0,0 +1,454 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "FixedTimestep.h"
+#include "MessageStream.h"
+#include "Protocol.h"
+#include "Room.h"
+#include "ThreadPool.h"
+
+using namespace std;
+using namespace deflection;
+
+/**
+ * The most bytes waiting to be sent to a client before MSG_STATEs for it are
+ * dropped. A state replaces the one before it, so a client that reads too
+ * slowly misses states instead of making the server buffer without bound.
+ */
+static constexpr size_t MAX_PENDING_BYTES = 1 << 20;
+
+/**
+ * The most bytes waiting to be sent to a client before it is disconnected.
+ * Only MSG_STATEs are dropped at MAX_PENDING_BYTES, so this bounds what a
+ * client that stops reading can still be sent, such as the MSG_LEVELs of the
+ * rooms it joins and the MSG_ERRORs of its commands.
+ */
+static constexpr size_t MAX_BUFFERED_BYTES = 4 << 20;
+
+/** The number of rooms in each chunk of a tick run across the threads. */
+static constexpr unsigned int ROOMS_PER_CHUNK = 16;
+
+/**
+ * The options of the server.
+ */
+struct ServerOptions {
+    /** The path of the Unix domain socket to listen on, or empty for TCP. */
+    string socket;
+
+    /** The loopback TCP port to listen on, when there is no socket path. */
+    unsigned int port = DEFAULT_PORT;
+
+    /** The number of rooms hosted. */
+    unsigned int rooms = 1000;
+
+    /** The number of walls in each level. */
+    unsigned int walls = 10;
+
+    /** The number of ticks per second of every room. */
+    unsigned int tickRate = 60;
+
+    /** The number of threads the rooms are ticked across, 0 for one per hardware thread. */
+    unsigned int threads = 0;
+
+    /** The number of ticks between the MSG_STATEs of a room. */
+    unsigned int stateEvery = 1;
+
+    /** The most projectiles in a room at once. */
+    unsigned int maxProjectiles = 256;
+
+    /** The seed of the levels of the first room, each room using the next. */
+    unsigned int seed = 1;
+
+    /** Whether only winnable levels are generated. */
+    bool winnable = false;
+
+    /** The number of seconds to run for, or 0 to run until killed. */
+    unsigned int seconds = 0;
+
+    /** The width of the screen of the levels. */
+    unsigned int width = 640;
+
+    /** The height of the screen of the levels. */
+    unsigned int height = 480;
+};
+
+/**
+ * A client connected to the server.
+ */
+struct Connection {
+    /** The messages to and from the client. */
+    unique_ptr<MessageStream> stream;
+
+    /** The rooms the client has joined. */
+    vector<uint32_t> rooms;
+};
+
+/**
+ * What the server did over the last whole second, printed once a second.
+ */
+struct ServerStats {
+    /** How long after it was due each tick had its messages handed to the sockets, in seconds. */
+    vector<double> latencies;
+
+    /** How long ticking every room took for each tick, in seconds. */
+    vector<double> tickSeconds;
+
+    /** The number of MSG_STATEs dropped for clients that read too slowly. */
+    unsigned long long droppedStates = 0;
+
+    /** The number of commands dropped for rooms with too many waiting. */
+    unsigned long long droppedCommands = 0;
+};
+
+/**
+ * Prints the usage of the server to the given stream.
+ * @param out is the stream to print to.
+ */
+static void printUsage(ostream& out) {
+    out << "Usage: server [--socket PATH] [--port N] [--rooms N] [--walls N]"
+            << " [--tick-rate N] [--threads N] [--state-every N]"
+            << " [--max-projectiles N] [--seed N] [--winnable 0|1] [--seconds N]"
+            << " [--width N] [--height N]" << endl;
+}
+
+/**
+ * Parses the command line arguments into server options.
+ * @param argc is the number of arguments.
+ * @param argv is the array of arguments.
+ * @return the parsed options.
+ * @throw invalid_argument if an argument is unknown or is missing its value.
+ */
+static ServerOptions parseOptions(int argc, char* argv[]) {
+    ServerOptions options;
+    for (int i = 1; i < argc; i += 1) {
+        const string name = argv[i];
+        if (i + 1 == argc) {
+            throw invalid_argument("Missing value for " + name);
+        }
+        if (name == "--socket") {
+            options.socket = argv[i + 1];
+            i += 1;
+            continue;
+        }
+        unsigned int value = stoul(argv[i + 1]);
+        i += 1;
+        if (name == "--port") {
+            options.port = value;
+        } else if (name == "--rooms") {
+            options.rooms = value;
+        } else if (name == "--walls") {
+            options.walls = value;
+        } else if (name == "--tick-rate") {
+            options.tickRate = value;
+        } else if (name == "--threads") {
+            options.threads = value;
+        } else if (name == "--state-every") {
+            options.stateEvery = value;
+        } else if (name == "--max-projectiles") {
+            options.maxProjectiles = value;
+        } else if (name == "--seed") {
+            options.seed = value;
+        } else if (name == "--winnable") {
+            options.winnable = value != 0;
+        } else if (name == "--seconds") {
+            options.seconds = value;
+        } else if (name == "--width") {
+            options.width = value;
+        } else if (name == "--height") {
+            options.height = value;
+        } else {
+            throw invalid_argument("Unknown option " + name);
+        }
+    }
+    if (options.port > 65535 || options.tickRate == 0 || options.stateEvery == 0
+            || options.maxProjectiles == 0) {
+        throw invalid_argument("The port, tick rate, state interval or projectile limit is out of range");
+    }
+    return options;
+}
+
+/**
+ * Handles a message from a client, joining, leaving, or queueing a command
+ * for a room. A message that cannot be handled is answered with a MSG_ERROR.
+ * @param connection is the client the message came from.
+ * @param header is the header of the message.
+ * @param body is the body of the message.
+ * @param rooms is the rooms of the server.
+ * @param members is the clients that have joined each room.
+ * @param stats is the stats of the current second.
+ */
+static void handleMessage(Connection& connection, const MessageHeader& header,
+        const unsigned char* body, vector<unique_ptr<Room>>& rooms,
+        vector<vector<Connection*>>& members, ServerStats& stats) {
+    if (header.room >= rooms.size()) {
+        connection.stream->send(MSG_ERROR, header.room, nullptr, 0);
+        return;
+    }
+    Room& room = *rooms[header.room];
+    vector<Connection*>& roomMembers = members[header.room];
+    bool handled = true;
+    if (header.type == MSG_JOIN || header.type == MSG_LEAVE) {
+        auto joined = find(connection.rooms.begin(), connection.rooms.end(), header.room);
+        if (header.type == MSG_JOIN && joined == connection.rooms.end()) {
+            connection.rooms.push_back(header.room);
+            roomMembers.push_back(&connection);
+        } else if (header.type == MSG_LEAVE && joined != connection.rooms.end()) {
+            connection.rooms.erase(joined);
+            roomMembers.erase(find(roomMembers.begin(), roomMembers.end(), &connection));
+        }
+        if (header.type == MSG_JOIN) {
+            vector<unsigned char> level;
+            room.writeLevel(level);
+            connection.stream->append(level.data(), level.size());
+        }
+    } else if (header.type == MSG_FIRE && header.length == sizeof(FireMessage)) {
+        FireMessage fire;
+        memcpy(&fire, body, sizeof(fire));
+        handled = room.fire(fire.x, fire.y, fire.tag);
+    } else if (header.type == MSG_RESTART) {
+        handled = room.restart();
+    } else {
+        handled = false;
+    }
+    if (!handled) {
+        stats.droppedCommands += 1;
+        connection.stream->send(MSG_ERROR, header.room, nullptr, 0);
+    }
+}
+
+/**
+ * Prints the stats of the second that has just ended, and clears them.
+ * @param stats is the stats of the second.
+ * @param seconds is the length of the second, in seconds.
+ * @param cpuSeconds is the processor time used in the second, in seconds.
+ * @param numRooms is the number of rooms.
+ * @param numClients is the number of connected clients.
+ * @param bytesIn is the number of bytes received in the second.
+ * @param bytesOut is the number of bytes sent in the second.
+ * @param droppedTicks is the number of ticks dropped since the server started.
+ */
+static void printStats(ServerStats& stats, double seconds, double cpuSeconds,
+        unsigned int numRooms, size_t numClients, unsigned long long bytesIn,
+        unsigned long long bytesOut, unsigned long long droppedTicks) {
+    vector<double>& latencies = stats.latencies;
+    vector<double>& ticks = stats.tickSeconds;
+    if (!latencies.empty()) {
+        sort(latencies.begin(), latencies.end());
+        sort(ticks.begin(), ticks.end());
+        double busyCores = cpuSeconds / seconds;
+        cout << "Rooms: " << numRooms
+                << ", clients: " << numClients
+                << ", ticks: " << ticks.size()
+                << ", tick p50 ms: " << ticks[ticks.size() / 2] * 1000.0
+                << ", tick p99 ms: " << ticks[min(ticks.size() - 1, ticks.size() * 99 / 100)] * 1000.0
+                << ", latency p50 ms: " << latencies[latencies.size() / 2] * 1000.0
+                << ", latency p99 ms: "
+                << latencies[min(latencies.size() - 1, latencies.size() * 99 / 100)] * 1000.0
+                << ", latency max ms: " << latencies.back() * 1000.0
+                << endl;
+        cout << "Busy cores: " << busyCores
+                << ", rooms per core: " << (busyCores > 0.0 ? numRooms / busyCores : 0.0)
+                << ", bytes per room per second in: " << bytesIn / seconds / max(1u, numRooms)
+                << ", out: " << bytesOut / seconds / max(1u, numRooms)
+                << ", dropped states: " << stats.droppedStates
+                << ", dropped commands: " << stats.droppedCommands
+                << ", dropped ticks: " << droppedTicks << endl;
+    }
+    stats = ServerStats();
+}
+
+/**
+ * A server hosting many independent rooms of the game in one process, for
+ * clients connected over a Unix domain socket or loopback TCP. Every room
+ * ticks at the same fixed rate, and each tick runs all the rooms in chunks
+ * across a ThreadPool, so rooms are spread over the cores without a thread
+ * of their own. The main thread does all the I/O: it polls the sockets and
+ * queues the commands of clients for their rooms between ticks, and after a
+ * tick sends each room's messages to the clients in it. Once a second the
+ * tick time and latency percentiles, the rooms per busy core, and the bytes
+ * per room per second are printed.
+ * @return The status code. Status code 0 means
+ * the program succeeds, and nonzero status code
+ * means the program failed.
+ */
+int main(int argc, char* argv[]) {
+    ServerOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        printUsage(cerr);
+        return 1;
+    }
+    try {
+        vector<unique_ptr<Room>> rooms;
+        rooms.reserve(options.rooms);
+        auto buildStart = chrono::steady_clock::now();
+        for (unsigned int r = 0; r < options.rooms; r += 1) {
+            rooms.emplace_back(new Room(r, options.width, options.height, options.walls,
+                    options.seed + r, options.maxProjectiles, options.winnable,
+                    1.0 / options.tickRate));
+        }
+        vector<vector<Connection*>> members(options.rooms);
+        ThreadPool pool(options.threads);
+
+        int listener = MessageStream::listen(options.socket, options.port);
+        cout << "Hosting " << options.rooms << " rooms on "
+                << (options.socket.empty() ? "port " + to_string(options.port) : options.socket)
+                << " with " << pool.getNumThreads() << " threads, started in "
+                << chrono::duration<double>(chrono::steady_clock::now() - buildStart).count() * 1000.0
+                << " ms" << endl;
+
+        vector<unique_ptr<Connection>> connections;
+        vector<pollfd> fds;
+        FixedTimestep timestep(options.tickRate);
+        const double tickSeconds = timestep.getTickSeconds();
+        unsigned long long tick = 0;
+        ServerStats stats;
+        unsigned long long closedBytesIn = 0;
+        unsigned long long closedBytesOut = 0;
+        unsigned long long lastBytesIn = 0;
+        unsigned long long lastBytesOut = 0;
+
+        auto start = chrono::steady_clock::now();
+        auto last = start;
+        auto secondStart = start;
+        clock_t secondClock = clock();
+        while (options.seconds == 0 || last - start < chrono::seconds(options.seconds)) {
+            // Wait for the sockets until the next tick is due
+            fds.clear();
+            fds.push_back({listener, POLLIN, 0});
+            for (const unique_ptr<Connection>& connection : connections) {
+                short events = POLLIN;
+                if (connection->stream->getPendingBytes() > 0) {
+                    events |= POLLOUT;
+                }
+                fds.push_back({connection->stream->getFd(), events, 0});
+            }
+            int wait = static_cast<int>(ceil((1.0 - timestep.getAlpha()) * tickSeconds * 1000.0));
+            poll(fds.data(), fds.size(), max(0, wait));
+
+            // Accept new clients, which take no rooms until they join them
+            if (fds[0].revents & POLLIN) {
+                int fd;
+                while ((fd = accept(listener, nullptr, nullptr)) >= 0) {
+                    connections.emplace_back(new Connection());
+                    connections.back()->stream.reset(new MessageStream(fd, MAX_CLIENT_BODY));
+                }
+            }
+
+            // Read the clients polled, dropping the ones that are gone or too
+            // far behind
+            for (size_t c = 0, f = 1; c < connections.size(); f += 1) {
+                Connection& connection = *connections[c];
+                bool open = true;
+                if (f < fds.size() && fds[f].revents != 0) {
+                    open = connection.stream->receive();
+                    MessageHeader header;
+                    const unsigned char* body;
+                    while (connection.stream->next(header, body)) {
+                        handleMessage(connection, header, body, rooms, members, stats);
+                    }
+                    open = open && !connection.stream->isBroken() && connection.stream->flush();
+                }
+                open = open && connection.stream->getPendingBytes() <= MAX_BUFFERED_BYTES;
+                if (open) {
+                    c += 1;
+                    continue;
+                }
+                for (uint32_t r : connection.rooms) {
+                    vector<Connection*>& roomMembers = members[r];
+                    roomMembers.erase(find(roomMembers.begin(), roomMembers.end(), &connection));
+                }
+                closedBytesIn += connection.stream->getBytesReceived();
+                closedBytesOut += connection.stream->getBytesSent();
+                connections.erase(connections.begin() + c);
+            }
+
+            // Run the ticks that are due, every room at once across the
+            // threads, and then send what each room wrote to its clients
+            auto now = chrono::steady_clock::now();
+            unsigned int ticks = timestep.advance(chrono::duration<double>(now - last).count());
+            last = now;
+            double late = timestep.getAlpha() * tickSeconds;
+            for (unsigned int t = 0; t < ticks; t += 1) {
+                tick += 1;
+                bool sendState = tick % options.stateEvery == 0;
+                auto tickStart = chrono::steady_clock::now();
+                pool.parallelFor(rooms.size(), ROOMS_PER_CHUNK,
+                        [&](unsigned int /*chunk*/, unsigned int begin, unsigned int end) {
+                    for (unsigned int r = begin; r < end; r += 1) {
+                        rooms[r]->tick(tickSeconds, sendState);
+                    }
+                });
+                stats.tickSeconds.push_back(
+                        chrono::duration<double>(chrono::steady_clock::now() - tickStart).count());
+                for (unsigned int r = 0; r < rooms.size(); r += 1) {
+                    const vector<unsigned char>& output = rooms[r]->getOutput();
+                    if (output.empty()) {
+                        continue;
+                    }
+                    for (Connection* connection : members[r]) {
+                        if (connection->stream->getPendingBytes() > MAX_PENDING_BYTES
+                                && !rooms[r]->levelChanged()) {
+                            stats.droppedStates += 1;
+                        } else {
+                            connection->stream->append(output.data(), output.size());
+                        }
+                    }
+                }
+            }
+            if (ticks > 0) {
+                for (const unique_ptr<Connection>& connection : connections) {
+                    connection->stream->flush();
+                }
+                stats.latencies.push_back(late
+                        + chrono::duration<double>(chrono::steady_clock::now() - now).count());
+            }
+
+            if (now - secondStart >= chrono::seconds(1)) {
+                unsigned long long bytesIn = closedBytesIn;
+                unsigned long long bytesOut = closedBytesOut;
+                for (const unique_ptr<Connection>& connection : connections) {
+                    bytesIn += connection->stream->getBytesReceived();
+                    bytesOut += connection->stream->getBytesSent();
+                }
+                clock_t nowClock = clock();
+                printStats(stats, chrono::duration<double>(now - secondStart).count(),
+                        static_cast<double>(nowClock - secondClock) / CLOCKS_PER_SEC,
+                        rooms.size(), connections.size(), bytesIn - lastBytesIn,
+                        bytesOut - lastBytesOut, timestep.getDroppedTicks());
+                lastBytesIn = bytesIn;
+                lastBytesOut = bytesOut;
+                secondStart = now;
+                secondClock = nowClock;
+            }
+        }
+
+        connections.clear();
+        close(listener);
+        if (!options.socket.empty()) {
+            unlink(options.socket.c_str());
+        }
+        unsigned long long levelsWon = 0;
+        for (const unique_ptr<Room>& room : rooms) {
+            levelsWon += room->getLevelsWon();
+        }
+        cout << "Ticks: " << tick << ", levels won: " << levelsWon << endl;
+        return 0;
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,396 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "ActiveGame.h"
+#include "InputLog.h"
+#include "LevelGenerator.h"
+
+using namespace std;
+using namespace deflection;
+
+/**
+ * The options of a headless simulation run.
+ */
+struct SimulationOptions {
+    /** The number of levels to simulate. */
+    unsigned int levels = 1000;
+
+    /** The number of walls in each level. */
+    unsigned int walls = 10;
+
+    /** The number of shots fired in each level. */
+    unsigned int shots = 20;
+
+    /** The number of ticks simulated in each level. */
+    unsigned int ticks = 600;
+
+    /** The seed for level generation and for the scripted shots. */
+    unsigned int seed = 1;
+
+    /** The width of the simulated screen. */
+    unsigned int width = 640;
+
+    /** The height of the simulated screen. */
+    unsigned int height = 480;
+
+    /** Whether only winnable levels are generated. */
+    bool winnable = false;
+
+    /** Whether to solve each level instead of playing it. */
+    bool solve = false;
+
+    /** Whether to benchmark level generation instead of playing levels. */
+    bool generate = false;
+
+    /**
+     * The location of a level corpus to play the levels of in order, instead
+     * of generating levels, or empty to generate them.
+     */
+    string corpus;
+
+    /**
+     * The location of an input log recorded by the game to replay, instead of
+     * playing scripted shots, or empty to play scripted shots.
+     */
+    string replay;
+};
+
+/**
+ * Prints the usage of the headless simulation to the given stream.
+ * @param out is the stream to print to.
+ */
+static void printUsage(ostream& out) {
+    out << "Usage: simulate [--levels N] [--walls N] [--shots N] [--ticks N]"
+            << " [--seed N] [--width N] [--height N] [--winnable 0|1] [--solve 0|1]"
+            << " [--generate 0|1] [--corpus FILE]"
+            << " [--replay FILE]" << endl;
+}
+
+/**
+ * Parses the command line arguments into simulation options.
+ * @param argc is the number of arguments.
+ * @param argv is the array of arguments.
+ * @return the parsed options.
+ * @throw invalid_argument if an argument is unknown or is missing its value.
+ */
+static SimulationOptions parseOptions(int argc, char* argv[]) {
+    SimulationOptions options;
+    for (int i = 1; i < argc; i += 1) {
+        const string name = argv[i];
+        if (i + 1 == argc) {
+            throw invalid_argument("Missing value for " + name);
+        }
+        if (name == "--corpus" || name == "--replay") {
+            (name == "--corpus" ? options.corpus : options.replay) = argv[i + 1];
+            i += 1;
+            continue;
+        }
+        unsigned int value = stoul(argv[i + 1]);
+        i += 1;
+        if (name == "--levels") {
+            options.levels = value;
+        } else if (name == "--walls") {
+            options.walls = value;
+        } else if (name == "--shots") {
+            options.shots = value;
+        } else if (name == "--ticks") {
+            options.ticks = value;
+        } else if (name == "--seed") {
+            options.seed = value;
+        } else if (name == "--width") {
+            options.width = value;
+        } else if (name == "--height") {
+            options.height = value;
+        } else if (name == "--winnable") {
+            options.winnable = value != 0;
+        } else if (name == "--solve") {
+            options.solve = value != 0;
+        } else if (name == "--generate") {
+            options.generate = value != 0;
+        } else {
+            throw invalid_argument("Unknown option " + name);
+        }
+    }
+    return options;
+}
+
+/**
+ * Starts the given level of the game, taking it from the corpus if there is
+ * one, and generating it otherwise.
+ * @param game is the ActiveGame to start the level of.
+ * @param corpus is the LevelCorpus to take levels from, or null.
+ * @param level is the number of the level, wrapping around the corpus.
+ */
+static void startLevel(ActiveGame& game, const LevelCorpus* corpus, unsigned int level) {
+    if (corpus != nullptr) {
+        game.startLevel(*corpus, level % corpus->size());
+    } else {
+        game.startNewGame();
+    }
+}
+
+/**
+ * Solves each of the given number of levels of the game, finding all the
+ * winning shots, and prints the winning angles and the time taken for each
+ * level, followed by a summary.
+ * @param game is the ActiveGame to generate levels with.
+ * @param corpus is the LevelCorpus to take levels from, or null.
+ * @param levels is the number of levels to solve.
+ */
+static void solveLevels(ActiveGame& game, const LevelCorpus* corpus, unsigned int levels) {
+    unsigned int winnable = 0;
+    double totalSeconds = 0.0;
+    double maxSeconds = 0.0;
+    double totalFirstWinSeconds = 0.0;
+    for (unsigned int level = 0; level < levels; level += 1) {
+        // Time both stopping at the first win, as startNewGame does, and
+        // finding every winning shot
+        SolveResult first = game.solveLevel(true);
+        SolveResult all = game.solveLevel(false);
+        cout << "Level " << level << ": " << all.winningAngles.size() << " of "
+                << all.anglesTested << " angles win, first win in "
+                << first.seconds * 1000.0 << " ms, all in " << all.seconds * 1000.0 << " ms";
+        for (unsigned int i = 0; i < all.winningAngles.size() && i < 8; i += 1) {
+            cout << (i == 0 ? ": " : ", ") << all.winningAngles[i];
+        }
+        cout << (all.winningAngles.size() > 8 ? ", ..." : "") << endl;
+        winnable += all.winnable ? 1 : 0;
+        totalSeconds += all.seconds;
+        maxSeconds = max(maxSeconds, all.seconds);
+        totalFirstWinSeconds += first.seconds;
+        startLevel(game, corpus, level + 1);
+    }
+    cout << "Winnable levels: " << winnable << " of " << levels << endl;
+    cout << "Mean milliseconds to first win: " << totalFirstWinSeconds * 1000.0 / levels << endl;
+    cout << "Mean milliseconds to find all wins: " << totalSeconds * 1000.0 / levels << endl;
+    cout << "Max milliseconds to find all wins: " << maxSeconds * 1000.0 << endl;
+}
+
+/**
+ * Generates levels of the given size with the given number of walls, and
+ * prints a row of the generation benchmark for them.
+ * @param width is the width of the screen.
+ * @param height is the height of the screen.
+ * @param numWalls is the number of walls to place.
+ * @param maxWallLength is the longest a wall may be.
+ * @param seed is the seed for the random number generator.
+ */
+static void benchmarkGeneration(unsigned int width, unsigned int height,
+        unsigned int numWalls, unsigned int maxWallLength, unsigned int seed) {
+    LevelGenerator generator(width, height, 0, 1, 2, maxWallLength);
+    mt19937 r(seed);
+    Player player(0, 0, 0, 0);
+    ImageObject target(0, 0, 0, 0, 0, 0);
+    vector<ImageObject> walls;
+
+    // Repeat small levels enough times for a stable time
+    unsigned int repetitions = max(3u, 20000 / max(1u, numWalls));
+    unsigned long long placed = 0;
+    unsigned long long attempts = 0;
+    auto start = chrono::steady_clock::now();
+    for (unsigned int i = 0; i < repetitions; i += 1) {
+        GenerationResult result = generator.generate(r, numWalls, player, target, walls);
+        placed += result.wallsPlaced;
+        attempts += result.attempts;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << width << "x" << height << "\t" << numWalls << "\t"
+            << (double) placed / repetitions << "\t" << (double) attempts / repetitions << "\t"
+            << seconds * 1000.0 / repetitions << endl;
+}
+
+/**
+ * Benchmarks level generation against the number of walls. Levels are
+ * generated both with the screen growing with the number of walls, keeping
+ * the density of the given screen with 10 walls, and on the given screen
+ * itself, where crowded levels run out of candidates.
+ * @param options are the simulation options.
+ */
+static void benchmarkGeneration(const SimulationOptions& options) {
+    cout << "Screen\tWalls\tPlaced\tAttempts\tMilliseconds per level" << endl;
+    for (unsigned int numWalls = 10; numWalls <= 100000; numWalls *= 10) {
+        double scale = sqrt(numWalls / 10.0);
+        benchmarkGeneration(options.width * scale, options.height * scale, numWalls,
+                options.width, options.seed);
+    }
+    for (unsigned int numWalls = 10; numWalls <= 10000; numWalls *= 10) {
+        benchmarkGeneration(options.width, options.height, numWalls, options.width, options.seed);
+    }
+}
+
+/**
+ * Replays a session recorded by the game, applying each input before the tick
+ * it was recorded at and running the ticks in between as fast as possible,
+ * exactly as the game ran them. Prints the outcome of the session and the
+ * replay speed.
+ * @param options are the simulation options, of which the replay and the
+ * corpus are used.
+ * @throw domain_error if the log cannot be read, or needs a corpus that was
+ * not given.
+ */
+static void replaySession(const SimulationOptions& options) {
+    InputLog log(options.replay);
+    const InputLogHeader& header = log.getHeader();
+    unique_ptr<LevelCorpus> corpus;
+    if ((header.flags & INPUT_LOG_CORPUS) != 0) {
+        if (options.corpus.empty()) {
+            throw domain_error("The input log " + options.replay + " needs its level corpus");
+        }
+        corpus.reset(new LevelCorpus(options.corpus));
+        if (corpus->size() == 0) {
+            throw domain_error("The level corpus " + options.corpus + " has no levels");
+        }
+    }
+
+    // Set up the game the same way the game did, with image indices that are
+    // irrelevant without a display
+    auto start = chrono::steady_clock::now();
+    ActiveGame game(header.screenWidth, header.screenHeight, 0, 1, 2, 3,
+            header.numWalls, header.seed);
+    unsigned int corpusLevel = 0;
+    auto nextLevel = [&]() {
+        if (corpus) {
+            game.startLevel(*corpus, corpusLevel % corpus->size());
+            corpusLevel += 1;
+        } else {
+            game.startNewGame();
+        }
+    };
+    const double tickSeconds = 1.0 / header.tickRate;
+    game.setNumThreads(0);
+    game.setTickSeconds(tickSeconds);
+    game.setRequireWinnable((header.flags & INPUT_LOG_WINNABLE) != 0);
+    nextLevel();
+
+    const vector<InputRecord>& inputs = log.getInputs();
+    unsigned int levelsBeaten = 0;
+    unsigned int shots = 0;
+    unsigned int next = 0;
+    for (uint32_t tick = 0;; tick += 1) {
+        // Apply the inputs recorded before this tick
+        for (; next < inputs.size() && inputs[next].tick == tick; next += 1) {
+            if (inputs[next].type == INPUT_FIRE) {
+                game.playerFire(inputs[next].x, inputs[next].y);
+                shots += 1;
+            } else if (inputs[next].type == INPUT_RESTART) {
+                nextLevel();
+            }
+        }
+        if (tick >= log.getNumTicks()) {
+            break;
+        }
+        game.updateState(tickSeconds);
+        if (game.checkGameWon()) {
+            levelsBeaten += 1;
+            nextLevel();
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Seed: " << header.seed << endl;
+    cout << "Inputs: " << inputs.size() << " (" << shots << " shots)" << endl;
+    cout << "Ticks: " << log.getNumTicks() << " (" << log.getNumTicks() / header.tickRate
+            << " seconds of play)" << endl;
+    cout << "Levels beaten: " << levelsBeaten << endl;
+    cout << "Projectiles at the end: " << game.getNumProjectiles() << endl;
+    cout << "Elapsed seconds: " << seconds << endl;
+    cout << "Ticks per second: " << log.getNumTicks() / seconds << endl;
+}
+
+/**
+ * Headless simulation of the deflection game. Runs many levels with scripted
+ * shots as fast as possible, without a Display, and reports the simulation
+ * throughput. Only the game logic (ActiveGame, Player, Projectile and
+ * ImageObject) is used, so this program does not link SDL. With --solve, each
+ * level is solved instead, reporting its winning shots and solve times, and
+ * with --generate, level generation is benchmarked against the number of walls.
+ * With --corpus, the levels of a corpus written by makecorpus are used in order
+ * instead of generated ones, and with --replay, a session recorded by the game
+ * with --record is replayed.
+ * @return The status code. Status code 0 means
+ * the program succeeds, and nonzero status code
+ * means the program failed.
+ */
+int main(int argc, char* argv[]) {
+    try {
+        SimulationOptions options = parseOptions(argc, argv);
+        if (!options.replay.empty()) {
+            replaySession(options);
+            return 0;
+        }
+        if (options.generate) {
+            benchmarkGeneration(options);
+            return 0;
+        }
+
+        // Image indices are irrelevant without a display
+        ActiveGame game(options.width, options.height, 0, 1, 2, 3,
+                options.walls, options.seed);
+        game.setNumThreads(0);
+        unique_ptr<LevelCorpus> corpus;
+        if (!options.corpus.empty()) {
+            corpus.reset(new LevelCorpus(options.corpus));
+            if (corpus->size() == 0) {
+                throw domain_error("The level corpus " + options.corpus + " has no levels");
+            }
+            game.startLevel(*corpus, 0);
+        } else if (options.winnable) {
+            game.setRequireWinnable(true);
+            game.startNewGame();
+        }
+        if (options.solve) {
+            solveLevels(game, corpus.get(), options.levels);
+            return 0;
+        }
+
+        // The scripted shots are aimed at random points on the screen
+        mt19937 r(options.seed);
+        uniform_int_distribution<int> distrX(0, options.width);
+        uniform_int_distribution<int> distrY(0, options.height);
+
+        // Spread the shots evenly across the ticks of a level
+        unsigned int ticksPerShot = options.shots == 0 ? 0 :
+                max(1u, options.ticks / options.shots);
+
+        unsigned long long ticks = 0;
+        unsigned long long projectileSteps = 0;
+        unsigned int levelsWon = 0;
+
+        auto start = chrono::steady_clock::now();
+        for (unsigned int level = 0; level < options.levels; level += 1) {
+            unsigned int shotsFired = 0;
+            for (unsigned int tick = 0; tick < options.ticks; tick += 1) {
+                if (shotsFired < options.shots && tick % ticksPerShot == 0) {
+                    game.playerFire(distrX(r), distrY(r));
+                    shotsFired += 1;
+                }
+                projectileSteps += game.getNumProjectiles();
+                game.updateState();
+                ticks += 1;
+                if (game.checkGameWon()) {
+                    levelsWon += 1;
+                    break;
+                }
+            }
+            startLevel(game, corpus.get(), level + 1);
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        cout << "Levels: " << options.levels << " (won " << levelsWon << ")" << endl;
+        cout << "Ticks: " << ticks << endl;
+        cout << "Projectile steps: " << projectileSteps << endl;
+        cout << "Elapsed seconds: " << seconds << endl;
+        cout << "Ticks per second: " << ticks / seconds << endl;
+        cout << "Projectile steps per second: " << projectileSteps / seconds << endl;
+        return 0;
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        printUsage(cerr);
+        return 1;
+    }
+}
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <iostream>
+#include "SimulationThread.h"
+#include "Trace.h"
+
+using namespace std;
+using namespace deflection;
+
+SimulationThread::SimulationThread(ActiveGame& game, double tickRate, unsigned int maxCatchUp,
+        function<void()> nextLevel, InputLogWriter* log) noexcept
+: game_(game), timestep_(tickRate, maxCatchUp), nextLevel_(move(nextLevel)), log_(log) {
+}
+
+SimulationThread::~SimulationThread() {
+    stopping_.store(true, memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void SimulationThread::start() {
+    publish(chrono::steady_clock::now());
+    stopping_.store(false, memory_order_release);
+    running_.store(true, memory_order_release);
+    thread_ = thread(&SimulationThread::run, this);
+}
+
+void SimulationThread::stop() {
+    stopping_.store(true, memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (error_) {
+        exception_ptr error = error_;
+        error_ = nullptr;
+        rethrow_exception(error);
+    }
+}
+
+bool SimulationThread::isRunning() const noexcept {
+    return running_.load(memory_order_acquire);
+}
+
+InputQueue& SimulationThread::getInputs() noexcept {
+    return inputs_;
+}
+
+TripleBuffer<FrameSnapshot>& SimulationThread::getSnapshots() noexcept {
+    return snapshots_;
+}
+
+void SimulationThread::run() noexcept {
+    try {
+        jitter_.reserve(1024);
+        auto last = chrono::steady_clock::now();
+        auto secondStart = last;
+        const double tickSeconds = timestep_.getTickSeconds();
+        while (!stopping_.load(memory_order_acquire)) {
+            applyInputs();
+
+            // Run the ticks that are due. The time left over is how long
+            // after it was due the last of them runs.
+            auto now = chrono::steady_clock::now();
+            unsigned int ticks = timestep_.advance(chrono::duration<double>(now - last).count());
+            last = now;
+            double late = timestep_.getAlpha() * tickSeconds;
+            for (unsigned int tick = 0; tick < ticks; tick += 1) {
+                {
+                    DEFLECTION_TRACE_SCOPE("updateState");
+                    game_.updateState(tickSeconds);
+                }
+                if (game_.checkGameWon()) {
+                    levelsBeaten_ += 1;
+                    cout << "Beat level! Number of levels beaten: " << levelsBeaten_
+                            << " (the winning shot bounced " << game_.getHitEvents().back().bounces
+                            << " times)" << endl;
+                    nextLevel_();
+                }
+            }
+            if (ticks > 0) {
+                jitter_.push_back(late);
+                secondTicks_ += ticks;
+                if (now - secondStart >= chrono::seconds(1)) {
+                    summarizeJitter();
+                    secondStart = now;
+                }
+                publish(now - chrono::duration_cast<chrono::steady_clock::duration>(
+                        chrono::duration<double>(late)));
+            }
+
+            // Sleep until the next tick is due
+            double wait = (1.0 - timestep_.getAlpha()) * tickSeconds;
+            this_thread::sleep_for(chrono::duration<double>(wait));
+        }
+    } catch (...) {
+        error_ = current_exception();
+    }
+    running_.store(false, memory_order_release);
+}
+
+void SimulationThread::applyInputs() {
+    InputEvent event;
+    bool recorded = false;
+    while (inputs_.pop(event)) {
+        unsigned long long tick = game_.getTick();
+        if (event.type == InputType::Restart) {
+            // Request to reset the game
+            if (log_) {
+                log_->record(tick, INPUT_RESTART);
+                recorded = true;
+            }
+            nextLevel_();
+        } else if (event.type == InputType::Press) {
+            // Pressed the left mouse button
+            if (log_) {
+                log_->record(tick, INPUT_FIRE, event.x, event.y);
+                recorded = true;
+            }
+            game_.playerFire(event.x, event.y);
+        }
+    }
+    if (recorded) {
+        log_->flush();
+    }
+}
+
+void SimulationThread::publish(chrono::steady_clock::time_point tickTime) noexcept {
+    DEFLECTION_TRACE_SCOPE("publish");
+    FrameSnapshot& snapshot = snapshots_.back();
+    const vector<DrawCommand>& draws = game_.getDrawList();
+    snapshot.draws.assign(draws.begin(), draws.end());
+    snapshot.tick = game_.getTick();
+    snapshot.tickTime = tickTime;
+    snapshot.tickSeconds = timestep_.getTickSeconds();
+    snapshot.stats = stats_;
+    snapshot.publishTime = chrono::steady_clock::now();
+    snapshots_.publish();
+}
+
+void SimulationThread::summarizeJitter() noexcept {
+    stats_.ticks = secondTicks_;
+    secondTicks_ = 0;
+    sort(jitter_.begin(), jitter_.end());
+    stats_.jitterP50 = jitter_[jitter_.size() / 2];
+    stats_.jitterP99 = jitter_[min(jitter_.size() - 1, jitter_.size() * 99 / 100)];
+    stats_.jitterMax = jitter_.back();
+    stats_.droppedTicks = timestep_.getDroppedTicks();
+    jitter_.clear();
+}
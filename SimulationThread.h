@@ -0,0 +1,201 @@
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "ActiveGame.h"
+#include "FixedTimestep.h"
+#include "InputLogWriter.h"
+#include "InputQueue.h"
+#include "TripleBuffer.h"
+
+namespace deflection {
+
+/**
+ * How steadily the simulation thread ticked over the last whole second.
+ */
+struct SimulationStats {
+
+    /** The number of ticks run in the second. */
+    unsigned int ticks = 0;
+
+    /** The median time ticks ran after they were due, in seconds. */
+    double jitterP50 = 0.0;
+
+    /** The 99th percentile time ticks ran after they were due, in seconds. */
+    double jitterP99 = 0.0;
+
+    /** The longest time a tick ran after it was due, in seconds. */
+    double jitterMax = 0.0;
+
+    /** The number of ticks dropped since the thread started. */
+    unsigned long long droppedTicks = 0;
+};
+
+/**
+ * What the render thread needs to draw one frame, published by the
+ * simulation thread after the ticks of each step.
+ */
+struct FrameSnapshot {
+
+    /** The DrawCommands of the game after the last tick. */
+    std::vector<DrawCommand> draws;
+
+    /** The number of ticks the game had run. */
+    unsigned long long tick = 0;
+
+    /**
+     * The time the last tick was due, which drawing interpolates from, so
+     * that objects reach their current centers one tick later.
+     */
+    std::chrono::steady_clock::time_point tickTime;
+
+    /** The time the snapshot was published. */
+    std::chrono::steady_clock::time_point publishTime;
+
+    /** The length of a tick, in seconds. */
+    double tickSeconds = 0.0;
+
+    /** The steadiness of the simulation over the last whole second. */
+    SimulationStats stats;
+};
+
+/**
+ * Runs an ActiveGame on its own thread at a fixed tick rate, so that a slow
+ * frame on the render thread, such as one waiting for vsync, does not delay
+ * the simulation, and a slow tick does not delay drawing. Input is passed in
+ * through a lock free InputQueue, and the game is passed out as a
+ * FrameSnapshot through a TripleBuffer, so neither thread waits for the
+ * other. While the thread runs, only it may use the game.
+ *
+ * @author Trevor Day
+ */
+class SimulationThread {
+public:
+
+    /**
+     * Constructs a new SimulationThread, which does not run until started.
+     * @param game is the ActiveGame to simulate, which must outlive this.
+     * @param tickRate is the number of ticks per second.
+     * @param maxCatchUp is the most ticks run at once to catch up.
+     * @param nextLevel starts the next level of the game, when it is won or
+     * the player asks for a new one.
+     * @param log is the InputLogWriter to record the inputs to, or nullptr.
+     */
+    SimulationThread(ActiveGame& game, double tickRate, unsigned int maxCatchUp,
+            std::function<void()> nextLevel, InputLogWriter* log) noexcept;
+
+    /**
+     * Destruct the SimulationThread, stopping it if it is running.
+     */
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    /**
+     * Publishes the game as it is and starts the thread.
+     */
+    void start();
+
+    /**
+     * Stops the thread and waits for it, after which the game may be used
+     * again.
+     * @throw the exception that stopped the thread early, if there was one.
+     */
+    void stop();
+
+    /**
+     * Returns whether the thread is still simulating. It stops early if
+     * starting a level fails.
+     * @return true if the thread is running.
+     */
+    bool isRunning() const noexcept;
+
+    /**
+     * Returns the queue that input for the game is pushed to, from a single
+     * thread.
+     * @return a reference to the InputQueue.
+     */
+    InputQueue& getInputs() noexcept;
+
+    /**
+     * Returns the buffer the snapshots of the game are published to, to be
+     * read from a single thread.
+     * @return a reference to the TripleBuffer of FrameSnapshots.
+     */
+    TripleBuffer<FrameSnapshot>& getSnapshots() noexcept;
+
+private:
+
+    /** The game being simulated. */
+    ActiveGame& game_;
+
+    /** Converts the real time since the last step into ticks. */
+    FixedTimestep timestep_;
+
+    /** Starts the next level of the game. */
+    std::function<void()> nextLevel_;
+
+    /** The log the inputs are recorded to, or nullptr. */
+    InputLogWriter* log_;
+
+    /** The input waiting for the game. */
+    InputQueue inputs_;
+
+    /** The snapshots of the game. */
+    TripleBuffer<FrameSnapshot> snapshots_;
+
+    /** The steadiness of the simulation over the last whole second. */
+    SimulationStats stats_;
+
+    /** How late the last tick of each step of the current second ran, in seconds. */
+    std::vector<double> jitter_;
+
+    /** The number of ticks run in the current second. */
+    unsigned int secondTicks_ = 0;
+
+    /** The number of levels beaten. */
+    unsigned int levelsBeaten_ = 0;
+
+    /** The thread, once started. */
+    std::thread thread_;
+
+    /** Whether the thread should stop. */
+    std::atomic<bool> stopping_{false};
+
+    /** Whether the thread is running. */
+    std::atomic<bool> running_{false};
+
+    /** The exception that stopped the thread early, if there was one. */
+    std::exception_ptr error_;
+
+    /**
+     * The loop of the thread.
+     */
+    void run() noexcept;
+
+    /**
+     * Applies the input waiting in the queue to the game, recording it.
+     */
+    void applyInputs();
+
+    /**
+     * Copies the game into the back snapshot and publishes it.
+     * @param tickTime is the time the last tick was due.
+     */
+    void publish(std::chrono::steady_clock::time_point tickTime) noexcept;
+
+    /**
+     * Summarizes the jitter of the ticks of the second that has just ended
+     * into stats_.
+     */
+    void summarizeJitter() noexcept;
+};
+}
+
+#endif /* SIMULATIONTHREAD_H */
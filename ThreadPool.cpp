@@ -0,0 +1,121 @@
+#include <algorithm>
+#include "ThreadPool.h"
+
+using namespace std;
+using namespace deflection;
+
+ThreadPool::ThreadPool(unsigned int numThreads) noexcept
+: numThreads_(numThreads != 0 ? numThreads : max(1u, thread::hardware_concurrency())) {
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (thread& t : threads_) {
+        t.join();
+    }
+}
+
+unsigned int ThreadPool::getNumThreads() const noexcept {
+    return numThreads_;
+}
+
+void ThreadPool::start() {
+    if (!queues_.empty()) {
+        return;
+    }
+    for (unsigned int i = 0; i < numThreads_; i += 1) {
+        queues_.emplace_back(new Queue());
+    }
+    for (unsigned int i = 0; i + 1 < numThreads_; i += 1) {
+        threads_.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+void ThreadPool::parallelFor(unsigned int count, unsigned int chunkSize,
+        const function<void(unsigned int, unsigned int, unsigned int)>& run) {
+    chunkSize = max(1u, chunkSize);
+    unsigned int numChunks = (count + chunkSize - 1) / chunkSize;
+    if (numChunks <= 1 || numThreads_ == 1) {
+        // Not worth waking anyone
+        for (unsigned int chunk = 0; chunk < numChunks; chunk += 1) {
+            run(chunk, chunk * chunkSize, min(count, (chunk + 1) * chunkSize));
+        }
+        return;
+    }
+    start();
+
+    // Deal the chunks out to the queues in turn, so neighbouring chunks start
+    // on different threads
+    pending_.store(numChunks, memory_order_relaxed);
+    for (unsigned int chunk = 0; chunk < numChunks; chunk += 1) {
+        Queue& queue = *queues_[chunk % numThreads_];
+        lock_guard<mutex> lock(queue.mutex);
+        queue.chunks.push_back({&run, chunk, chunk * chunkSize, min(count, (chunk + 1) * chunkSize)});
+    }
+    {
+        lock_guard<mutex> lock(mutex_);
+        generation_ += 1;
+    }
+    wake_.notify_all();
+
+    // Work alongside the threads, and then wait for the chunks they took
+    unsigned int self = numThreads_ - 1;
+    while (runOne(self)) {
+    }
+    unique_lock<mutex> lock(mutex_);
+    done_.wait(lock, [this]() {
+        return pending_.load(memory_order_acquire) == 0;
+    });
+}
+
+bool ThreadPool::runOne(unsigned int self) noexcept {
+    // Take from the front of the own queue, then steal from the back of the
+    // others
+    Chunk chunk;
+    bool found = false;
+    for (unsigned int i = 0; i < numThreads_ && !found; i += 1) {
+        Queue& queue = *queues_[(self + i) % numThreads_];
+        lock_guard<mutex> lock(queue.mutex);
+        if (!queue.chunks.empty()) {
+            if (i == 0) {
+                chunk = queue.chunks.front();
+                queue.chunks.pop_front();
+            } else {
+                chunk = queue.chunks.back();
+                queue.chunks.pop_back();
+            }
+            found = true;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    (*chunk.run)(chunk.index, chunk.begin, chunk.end);
+    if (pending_.fetch_sub(1, memory_order_acq_rel) == 1) {
+        lock_guard<mutex> lock(mutex_);
+        done_.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::work(unsigned int self) noexcept {
+    unsigned long long seen = 0;
+    for (;;) {
+        {
+            unique_lock<mutex> lock(mutex_);
+            wake_.wait(lock, [&]() {
+                return stopping_ || generation_ != seen;
+            });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+        }
+        while (runOne(self)) {
+        }
+    }
+}
@@ -0,0 +1,141 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace deflection {
+
+/**
+ * A work stealing pool of threads for splitting loops into chunks. Each
+ * thread has its own queue of chunks, taking work from the front of its own
+ * queue and stealing from the back of the others when it runs out, so uneven
+ * chunks even out across threads. The thread calling parallelFor works on the
+ * chunks too. The threads are started the first time they are needed, or by
+ * start.
+ *
+ * @author Trevor Day
+ */
+class ThreadPool {
+public:
+
+    /**
+     * Constructs a new ThreadPool.
+     * @param numThreads is the number of threads to split work across,
+     * including the calling thread, or 0 for one per hardware thread.
+     */
+    explicit ThreadPool(unsigned int numThreads = 0) noexcept;
+
+    /**
+     * Destruct the pool, stopping its threads.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Returns the number of threads work is split across.
+     * @return the number of threads, including the calling thread.
+     */
+    unsigned int getNumThreads() const noexcept;
+
+    /**
+     * Runs the given function on consecutive chunks of the range from 0 to
+     * count, in parallel, and returns once every chunk is done. Chunks may run
+     * in any order and on any thread.
+     * @param count is the size of the range.
+     * @param chunkSize is the size of each chunk, except the last.
+     * @param run is called with the index of each chunk and the begin and end
+     * of its range.
+     */
+    void parallelFor(unsigned int count, unsigned int chunkSize,
+            const std::function<void(unsigned int, unsigned int, unsigned int)>& run);
+
+    /**
+     * Starts the threads now, if they have not been started, so that a later
+     * parallelFor does not start them. Threads that were started before one
+     * failed to start are stopped when the pool is destroyed.
+     * @throw system_error if a thread cannot be started.
+     */
+    void start();
+
+private:
+
+    /**
+     * A chunk of a parallelFor.
+     */
+    struct Chunk {
+        /** The function to run on the chunk. */
+        const std::function<void(unsigned int, unsigned int, unsigned int)>* run;
+
+        /** The index of the chunk. */
+        unsigned int index;
+
+        /** The first index of the range of the chunk. */
+        unsigned int begin;
+
+        /** One past the last index of the range of the chunk. */
+        unsigned int end;
+    };
+
+    /**
+     * The queue of chunks of one thread.
+     */
+    struct Queue {
+        /** Guards the chunks. */
+        std::mutex mutex;
+
+        /** The chunks, taken from the front by the owner and the back by others. */
+        std::deque<Chunk> chunks;
+    };
+
+    /**
+     * The loop of each thread of the pool.
+     * @param self is the index of the queue of the thread.
+     */
+    void work(unsigned int self) noexcept;
+
+    /**
+     * Runs one chunk, from the given queue or stolen from another.
+     * @param self is the index of the queue to look in first.
+     * @return true if a chunk was run, false if every queue was empty.
+     */
+    bool runOne(unsigned int self) noexcept;
+
+    /** The number of threads work is split across. */
+    const unsigned int numThreads_;
+
+    /** The queues, one per thread, the last being the calling thread's. */
+    std::vector<std::unique_ptr<Queue>> queues_;
+
+    /** The threads of the pool, which do not include the calling thread. */
+    std::vector<std::thread> threads_;
+
+    /** The number of chunks of the current parallelFor that are not done. */
+    std::atomic<unsigned int> pending_{0};
+
+    /** Guards sleeping and waking the threads. */
+    std::mutex mutex_;
+
+    /** Wakes threads when there is work or when stopping. */
+    std::condition_variable wake_;
+
+    /** Wakes the calling thread when the last chunk is done. */
+    std::condition_variable done_;
+
+    /** Incremented for each parallelFor, so threads know there is new work. */
+    unsigned long long generation_ = 0;
+
+    /** Whether the threads should stop. */
+    bool stopping_ = false;
+};
+}
+
+#endif /* THREADPOOL_H */
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include "Trace.h"
+
+using namespace std;
+using namespace deflection;
+
+/**
+ * Returns the time of the steady clock in nanoseconds.
+ * @return the time in nanoseconds.
+ */
+static int64_t steadyNanoseconds() noexcept {
+    return chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Returns a small number for the calling thread, numbering threads in the
+ * order they first record a span.
+ * @return the number of the thread.
+ */
+static uint32_t threadNumber() noexcept {
+    static atomic<uint32_t> next{0};
+    thread_local uint32_t number = next.fetch_add(1, memory_order_relaxed);
+    return number;
+}
+
+Tracer::Tracer() noexcept : epoch_(steadyNanoseconds()) {
+}
+
+Tracer& Tracer::instance() noexcept {
+    static Tracer tracer;
+    return tracer;
+}
+
+uint64_t Tracer::now() const noexcept {
+    return steadyNanoseconds() - epoch_;
+}
+
+void Tracer::record(const char* name, uint64_t start, uint64_t end) noexcept {
+    // Claim the next slot of the ring, overwriting the oldest span. The stamp
+    // is cleared before the span is written and set after, so a reader that
+    // sees the same stamp before and after reading has a whole span.
+    uint64_t index = count_.fetch_add(1, memory_order_relaxed);
+    Slot& slot = slots_[index & (CAPACITY - 1)];
+    slot.stamp.store(0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot.name.store(name, memory_order_relaxed);
+    slot.start.store(start, memory_order_relaxed);
+    slot.duration.store(end - start, memory_order_relaxed);
+    slot.thread.store(threadNumber(), memory_order_relaxed);
+    slot.stamp.store(index + 1, memory_order_release);
+}
+
+bool Tracer::read(uint64_t index, TraceEvent& event) const noexcept {
+    const Slot& slot = slots_[index & (CAPACITY - 1)];
+    if (slot.stamp.load(memory_order_acquire) != index + 1) {
+        return false;
+    }
+    event.name = slot.name.load(memory_order_relaxed);
+    event.start = slot.start.load(memory_order_relaxed);
+    event.duration = slot.duration.load(memory_order_relaxed);
+    event.thread = slot.thread.load(memory_order_relaxed);
+    atomic_thread_fence(memory_order_acquire);
+    return slot.stamp.load(memory_order_relaxed) == index + 1;
+}
+
+void Tracer::writeChromeTrace(ostream& out) const {
+    uint64_t count = count_.load(memory_order_acquire);
+    uint64_t first = count > CAPACITY ? count - CAPACITY : 0;
+
+    // Complete events, with times in microseconds
+    out << "{\"traceEvents\":[";
+    bool empty = true;
+    for (uint64_t i = first; i < count; i += 1) {
+        TraceEvent event;
+        if (!read(i, event)) {
+            continue;
+        }
+        out << (empty ? "\n" : ",\n") << "{\"name\":\"" << event.name
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+                << ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << "}";
+        empty = false;
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}" << endl;
+}
+
+void Tracer::writeSummary(ostream& out, uint64_t window) const {
+    uint64_t count = count_.load(memory_order_acquire);
+    uint64_t first = count > CAPACITY ? count - CAPACITY : 0;
+    uint64_t end = now();
+    uint64_t since = end > window ? end - window : 0;
+
+    // Group the lengths of the spans by name, in the order the names are
+    // first seen
+    vector<const char*> names;
+    vector<vector<uint64_t>> durations;
+    for (uint64_t i = first; i < count; i += 1) {
+        TraceEvent event;
+        if (!read(i, event) || event.start + event.duration < since) {
+            continue;
+        }
+        unsigned int n = 0;
+        while (n < names.size() && strcmp(names[n], event.name) != 0) {
+            n += 1;
+        }
+        if (n == names.size()) {
+            names.push_back(event.name);
+            durations.emplace_back();
+        }
+        durations[n].push_back(event.duration);
+    }
+
+    for (unsigned int n = 0; n < names.size(); n += 1) {
+        vector<uint64_t>& d = durations[n];
+        sort(d.begin(), d.end());
+        out << names[n] << ": n " << d.size()
+                << ", p50 " << d[d.size() / 2] / 1e6 << " ms"
+                << ", p99 " << d[min(d.size() - 1, d.size() * 99 / 100)] / 1e6 << " ms" << endl;
+    }
+}
@@ -0,0 +1,189 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+namespace deflection {
+
+/**
+ * A timed span of work recorded by a Tracer.
+ */
+struct TraceEvent {
+
+    /** The name of the span, a string literal. */
+    const char* name;
+
+    /** The time the span started, in nanoseconds since the Tracer started. */
+    std::uint64_t start;
+
+    /** The length of the span, in nanoseconds. */
+    std::uint64_t duration;
+
+    /** The number of the thread that recorded the span. */
+    std::uint32_t thread;
+};
+
+/**
+ * Records timed spans of work into a ring buffer, keeping the most recent
+ * CAPACITY of them. Recording is lock free, so spans can be recorded from any
+ * thread, and costs two clock reads and one atomic increment. The spans can be
+ * written as Chrome trace events, to be opened in chrome://tracing or
+ * Perfetto, or summarized as percentiles of each kind of span.
+ *
+ * Spans are recorded with the DEFLECTION_TRACE_SCOPE macro, which compiles to
+ * nothing unless DEFLECTION_TRACE is defined. Each slot of the ring is stamped
+ * with the number of its span once the span is written, so the spans can be
+ * read while other threads are recording, and a span that is still being
+ * written or has been overwritten is skipped.
+ *
+ * @author Trevor Day
+ */
+class Tracer {
+public:
+
+    /** The number of spans kept, a power of two. */
+    static constexpr unsigned int CAPACITY = 1 << 16;
+
+    /** Whether DEFLECTION_TRACE_SCOPE records anything in this build. */
+#if defined(DEFLECTION_TRACE)
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+
+    /**
+     * Returns the Tracer of the program.
+     * @return a reference to the Tracer.
+     */
+    static Tracer& instance() noexcept;
+
+    /**
+     * Returns the current time, in nanoseconds since the Tracer started.
+     * @return the time in nanoseconds.
+     */
+    std::uint64_t now() const noexcept;
+
+    /**
+     * Records a span.
+     * @param name is the name of the span, which must be a string literal.
+     * @param start is the time the span started, from now.
+     * @param end is the time the span ended, from now.
+     */
+    void record(const char* name, std::uint64_t start, std::uint64_t end) noexcept;
+
+    /**
+     * Writes the recorded spans as a Chrome trace event JSON file.
+     * @param out is the stream to write to.
+     */
+    void writeChromeTrace(std::ostream& out) const;
+
+    /**
+     * Writes the median and 99th percentile length of each kind of span among
+     * the recorded spans that ended in the given last number of nanoseconds.
+     * @param out is the stream to write to.
+     * @param window is how far back to look, in nanoseconds.
+     */
+    void writeSummary(std::ostream& out, std::uint64_t window) const;
+
+private:
+
+    /** Constructs a Tracer, starting its clock. */
+    Tracer() noexcept;
+
+    /** The time the Tracer started, in steady clock nanoseconds. */
+    std::int64_t epoch_;
+
+    /**
+     * A slot of the ring, holding a TraceEvent in atomics so that it can be
+     * read while it is written.
+     */
+    struct Slot {
+
+        /**
+         * One more than the number of the span in the slot, stored after the
+         * span is written, or 0 while it is being written.
+         */
+        std::atomic<std::uint64_t> stamp{0};
+
+        /** The name of the span. */
+        std::atomic<const char*> name{nullptr};
+
+        /** The time the span started. */
+        std::atomic<std::uint64_t> start{0};
+
+        /** The length of the span. */
+        std::atomic<std::uint64_t> duration{0};
+
+        /** The number of the thread that recorded the span. */
+        std::atomic<std::uint32_t> thread{0};
+    };
+
+    /**
+     * Reads the span with the given number, if its slot still holds it and it
+     * has been written.
+     * @param index is the number of the span.
+     * @param event is set to the span.
+     * @return true if the span was read, false otherwise.
+     */
+    bool read(std::uint64_t index, TraceEvent& event) const noexcept;
+
+    /** The total number of spans recorded. */
+    std::atomic<std::uint64_t> count_{0};
+
+    /** The most recent spans, the oldest being overwritten first. */
+    std::array<Slot, CAPACITY> slots_;
+};
+
+/**
+ * Records a span from its construction to its destruction.
+ *
+ * @author Trevor Day
+ */
+class TraceScope {
+public:
+
+    /**
+     * Starts the span.
+     * @param name is the name of the span, which must be a string literal.
+     */
+    explicit TraceScope(const char* name) noexcept
+    : name_(name), start_(Tracer::instance().now()) {
+    }
+
+    /** Ends the span, recording it. */
+    ~TraceScope() {
+        Tracer& tracer = Tracer::instance();
+        tracer.record(name_, start_, tracer.now());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+
+    /** The name of the span. */
+    const char* name_;
+
+    /** The time the span started. */
+    std::uint64_t start_;
+};
+}
+
+#define DEFLECTION_TRACE_CONCAT_(a, b) a##b
+#define DEFLECTION_TRACE_CONCAT(a, b) DEFLECTION_TRACE_CONCAT_(a, b)
+
+/**
+ * Records the rest of the enclosing scope as a span with the given name, a
+ * string literal, if DEFLECTION_TRACE is defined, and does nothing otherwise.
+ */
+#if defined(DEFLECTION_TRACE)
+#define DEFLECTION_TRACE_SCOPE(name) \
+    ::deflection::TraceScope DEFLECTION_TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define DEFLECTION_TRACE_SCOPE(name) ((void) 0)
+#endif
+
+#endif /* TRACE_H */
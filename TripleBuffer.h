@@ -0,0 +1,86 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+
+namespace deflection {
+
+/**
+ * Passes the latest value from one writing thread to one reading thread
+ * without either of them waiting. The writer fills its back slot and
+ * publishes it, the reader takes the most recently published slot as its
+ * front, and the third slot is swapped between them with a single atomic
+ * exchange. Values published while the reader is busy are replaced by newer
+ * ones, so the reader always sees the latest and never a partly written one.
+ * The slots are reused, so values that own memory stop allocating once they
+ * have grown to their working size.
+ *
+ * @author Trevor Day
+ */
+template <typename T>
+class TripleBuffer {
+public:
+
+    /**
+     * Returns the slot the writer fills next, which the reader never sees
+     * until it is published. Only the writing thread may call this.
+     * @return a reference to the back slot.
+     */
+    T& back() noexcept {
+        return slots_[back_];
+    }
+
+    /**
+     * Publishes the back slot, and gives the writer another slot to fill.
+     * Only the writing thread may call this.
+     */
+    void publish() noexcept {
+        back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    /**
+     * Takes the most recently published slot as the front, if one has been
+     * published since the last call. Only the reading thread may call this.
+     * @return true if the front changed.
+     */
+    bool update() noexcept {
+        if ((middle_.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /**
+     * Returns the slot the reader took last, which the writer does not touch
+     * until the reader updates again. Only the reading thread may call this.
+     * @return a const reference to the front slot.
+     */
+    const T& front() const noexcept {
+        return slots_[front_];
+    }
+
+private:
+
+    /** The bits of middle_ holding the index of the slot. */
+    static constexpr unsigned int INDEX = 3;
+
+    /** The bit of middle_ set when its slot was published and not yet read. */
+    static constexpr unsigned int FRESH = 4;
+
+    /** The three slots. */
+    std::array<T, 3> slots_;
+
+    /** The index of the slot the writer is filling. */
+    unsigned int back_ = 0;
+
+    /** The index of the slot between the threads, and the FRESH bit. */
+    std::atomic<unsigned int> middle_{1};
+
+    /** The index of the slot the reader is reading. */
+    unsigned int front_ = 2;
+};
+}
+
+#endif /* TRIPLEBUFFER_H */
@@ -0,0 +1,30 @@
+#ifndef VEC2_H
+#define VEC2_H
+
+#include <array>
+
+namespace deflection {
+
+/**
+ * Represents a two dimensional vector, which is used both for points and for
+ * directions, with an x component and a y component.
+ *
+ * @author Trevor Day
+ */
+struct Vec2 {
+
+    /** The x component of this Vec2. */
+    double x;
+
+    /** The y component of this Vec2. */
+    double y;
+};
+
+/**
+ * Four Vec2s, used for the corners of a rectangle or for the normals of its
+ * sides. Being a fixed size array it lives on the stack and never allocates.
+ */
+typedef std::array<Vec2, 4> Quad;
+}
+
+#endif /* VEC2_H */
@@ -0,0 +1,234 @@
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#include <algorithm>
+#include <cmath>
+#include "WallGrid.h"
+
+// A definition of pi, the same as the one used to rotate ImageObjects
+#define PI 3.14159265
+
+// The center of the walls in unused lanes, far outside of any screen
+#define UNUSED_LANE 1e30
+
+using namespace std;
+using namespace deflection;
+
+WallGrid::WallGrid() noexcept {
+}
+
+unsigned int WallGrid::column(double x) const noexcept {
+    double c = floor(x / cellSize_);
+    return c < 0 ? 0 : (c >= columns_ ? columns_ - 1 : (unsigned int) c);
+}
+
+unsigned int WallGrid::row(double y) const noexcept {
+    double r = floor(y / cellSize_);
+    return r < 0 ? 0 : (r >= rows_ ? rows_ - 1 : (unsigned int) r);
+}
+
+void WallGrid::build(const vector<ImageObject>& walls, unsigned int screenWidth,
+        unsigned int screenHeight, double cellSize) {
+    cellSize_ = cellSize;
+    columns_ = max(1u, (unsigned int) ceil(screenWidth / cellSize));
+    rows_ = max(1u, (unsigned int) ceil(screenHeight / cellSize));
+    unsigned int numCells = columns_ * rows_;
+
+    // Collect the cell of every overlapping pair of cell and wall. A wall is
+    // only put in a cell its rectangle actually overlaps, rather than every
+    // cell of its bounding box, so long diagonal walls stay cheap.
+    vector<pair<unsigned int, unsigned int> > pairs;
+    for (unsigned int i = 0; i < walls.size(); i += 1) {
+        const Quad& vertices = walls[i].getVertices();
+        double minX = vertices[0].x;
+        double maxX = vertices[0].x;
+        double minY = vertices[0].y;
+        double maxY = vertices[0].y;
+        for (const Vec2& v : vertices) {
+            minX = min(minX, v.x);
+            maxX = max(maxX, v.x);
+            minY = min(minY, v.y);
+            maxY = max(maxY, v.y);
+        }
+        unsigned int lastColumn = column(maxX);
+        unsigned int lastRow = row(maxY);
+        for (unsigned int r = row(minY); r <= lastRow; r += 1) {
+            for (unsigned int c = column(minX); c <= lastColumn; c += 1) {
+                // Edge cells reach out past the screen, so that walls which
+                // leave the screen are still found in them
+                double left = c == 0 ? min(minX, 0.0) : c * cellSize_;
+                double right = c + 1 == columns_ ? max(maxX, (c + 1) * cellSize_) : (c + 1) * cellSize_;
+                double top = r == 0 ? min(minY, 0.0) : r * cellSize_;
+                double bottom = r + 1 == rows_ ? max(maxY, (r + 1) * cellSize_) : (r + 1) * cellSize_;
+                ImageObject cell(0, (left + right) / 2.0, (top + bottom) / 2.0,
+                        right - left, bottom - top, 0);
+                if (walls[i].hits<Oriented, AxisAligned>(cell)) {
+                    pairs.push_back(make_pair(r * columns_ + c, i));
+                }
+            }
+        }
+    }
+
+    // Count the walls in each cell, and turn the counts into offsets of
+    // blocks of walls
+    vector<unsigned int> counts(numCells, 0);
+    for (const pair<unsigned int, unsigned int>& p : pairs) {
+        counts[get<0>(p)] += 1;
+    }
+    cellStarts_.assign(numCells + 1, 0);
+    for (unsigned int i = 0; i < numCells; i += 1) {
+        cellStarts_[i + 1] = cellStarts_[i] + (counts[i] + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    }
+
+    // Fill every lane as unused, and then place the walls. Walls were visited
+    // in order, so each cell keeps its walls in increasing order.
+    WallBlock empty;
+    for (unsigned int lane = 0; lane < BLOCK_SIZE; lane += 1) {
+        empty.cx[lane] = UNUSED_LANE;
+        empty.cy[lane] = UNUSED_LANE;
+        empty.ux[lane] = 1.0;
+        empty.uy[lane] = 0.0;
+        empty.halfWidth[lane] = 0.0;
+        empty.halfLength[lane] = 0.0;
+        empty.extentX[lane] = 0.0;
+        empty.extentY[lane] = 0.0;
+        empty.wall[lane] = 0;
+    }
+    blocks_.assign(cellStarts_[numCells], empty);
+    vector<unsigned int> next(numCells, 0);
+    for (const pair<unsigned int, unsigned int>& p : pairs) {
+        unsigned int cell = get<0>(p);
+        const ImageObject& w = walls[get<1>(p)];
+        WallBlock& block = blocks_[cellStarts_[cell] + next[cell] / BLOCK_SIZE];
+        unsigned int lane = next[cell] % BLOCK_SIZE;
+        next[cell] += 1;
+
+        double angle = w.getAngle() * PI / 180.0;
+        double c = cos(angle);
+        double s = sin(angle);
+        block.cx[lane] = w.getCenterX();
+        block.cy[lane] = w.getCenterY();
+        block.ux[lane] = c;
+        block.uy[lane] = s;
+        block.halfWidth[lane] = w.getWidth() / 2.0;
+        block.halfLength[lane] = w.getLength() / 2.0;
+        block.extentX[lane] = block.halfWidth[lane] * abs(c) + block.halfLength[lane] * abs(s);
+        block.extentY[lane] = block.halfWidth[lane] * abs(s) + block.halfLength[lane] * abs(c);
+        block.wall[lane] = get<1>(p);
+    }
+}
+
+void WallGrid::findHits(double x, double y, double halfWidth, double halfLength,
+        vector<unsigned int>& walls) const {
+    walls.clear();
+    if (columns_ == 0) {
+        return;
+    }
+    unsigned int firstColumn = column(x - halfWidth);
+    unsigned int lastColumn = column(x + halfWidth);
+    unsigned int firstRow = row(y - halfLength);
+    unsigned int lastRow = row(y + halfLength);
+    for (unsigned int r = firstRow; r <= lastRow; r += 1) {
+        for (unsigned int c = firstColumn; c <= lastColumn; c += 1) {
+            unsigned int cell = r * columns_ + c;
+            for (unsigned int b = cellStarts_[cell]; b < cellStarts_[cell + 1]; b += 1) {
+                // Add the wall of each set bit of the mask
+                unsigned int mask = hitMask(blocks_[b], x, y, halfWidth, halfLength);
+                for (unsigned int lane = 0; mask != 0; lane += 1, mask >>= 1) {
+                    if (mask & 1) {
+                        walls.push_back(blocks_[b].wall[lane]);
+                    }
+                }
+            }
+        }
+    }
+
+    // A wall crossing several of the cells may have been hit in each of them
+    if (lastColumn != firstColumn || lastRow != firstRow) {
+        sort(walls.begin(), walls.end());
+        walls.erase(unique(walls.begin(), walls.end()), walls.end());
+    }
+}
+
+unsigned int WallGrid::hitMask(const WallBlock& block, double x, double y,
+        double halfWidth, double halfLength) noexcept {
+
+    // For each wall, the box and the wall overlap on an axis when the distance
+    // between their centers along it is no more than the sum of their half
+    // extents along it. They collide when they overlap on all four axes.
+#if defined(__AVX2__)
+    const __m256d signBit = _mm256_set1_pd(-0.0);
+    const __m256d rx = _mm256_set1_pd(halfWidth);
+    const __m256d ry = _mm256_set1_pd(halfLength);
+    __m256d ux = _mm256_load_pd(block.ux);
+    __m256d uy = _mm256_load_pd(block.uy);
+    __m256d ax = _mm256_andnot_pd(signBit, ux);
+    __m256d ay = _mm256_andnot_pd(signBit, uy);
+    __m256d dx = _mm256_sub_pd(_mm256_set1_pd(x), _mm256_load_pd(block.cx));
+    __m256d dy = _mm256_sub_pd(_mm256_set1_pd(y), _mm256_load_pd(block.cy));
+
+    // The x and y axes of the box
+    __m256d overlap = _mm256_cmp_pd(_mm256_andnot_pd(signBit, dx),
+            _mm256_add_pd(_mm256_load_pd(block.extentX), rx), _CMP_LE_OQ);
+    overlap = _mm256_and_pd(overlap, _mm256_cmp_pd(_mm256_andnot_pd(signBit, dy),
+            _mm256_add_pd(_mm256_load_pd(block.extentY), ry), _CMP_LE_OQ));
+
+    // The axes along the width and along the length of the wall
+    __m256d du = _mm256_add_pd(_mm256_mul_pd(dx, ux), _mm256_mul_pd(dy, uy));
+    __m256d ru = _mm256_add_pd(_mm256_mul_pd(rx, ax), _mm256_mul_pd(ry, ay));
+    overlap = _mm256_and_pd(overlap, _mm256_cmp_pd(_mm256_andnot_pd(signBit, du),
+            _mm256_add_pd(_mm256_load_pd(block.halfWidth), ru), _CMP_LE_OQ));
+    __m256d dv = _mm256_sub_pd(_mm256_mul_pd(dy, ux), _mm256_mul_pd(dx, uy));
+    __m256d rv = _mm256_add_pd(_mm256_mul_pd(rx, ay), _mm256_mul_pd(ry, ax));
+    overlap = _mm256_and_pd(overlap, _mm256_cmp_pd(_mm256_andnot_pd(signBit, dv),
+            _mm256_add_pd(_mm256_load_pd(block.halfLength), rv), _CMP_LE_OQ));
+    return _mm256_movemask_pd(overlap);
+#elif defined(__SSE2__)
+    // Two lanes at a time
+    const __m128d signBit = _mm_set1_pd(-0.0);
+    const __m128d rx = _mm_set1_pd(halfWidth);
+    const __m128d ry = _mm_set1_pd(halfLength);
+    unsigned int mask = 0;
+    for (unsigned int lane = 0; lane < BLOCK_SIZE; lane += 2) {
+        __m128d ux = _mm_load_pd(block.ux + lane);
+        __m128d uy = _mm_load_pd(block.uy + lane);
+        __m128d ax = _mm_andnot_pd(signBit, ux);
+        __m128d ay = _mm_andnot_pd(signBit, uy);
+        __m128d dx = _mm_sub_pd(_mm_set1_pd(x), _mm_load_pd(block.cx + lane));
+        __m128d dy = _mm_sub_pd(_mm_set1_pd(y), _mm_load_pd(block.cy + lane));
+
+        __m128d overlap = _mm_cmple_pd(_mm_andnot_pd(signBit, dx),
+                _mm_add_pd(_mm_load_pd(block.extentX + lane), rx));
+        overlap = _mm_and_pd(overlap, _mm_cmple_pd(_mm_andnot_pd(signBit, dy),
+                _mm_add_pd(_mm_load_pd(block.extentY + lane), ry)));
+
+        __m128d du = _mm_add_pd(_mm_mul_pd(dx, ux), _mm_mul_pd(dy, uy));
+        __m128d ru = _mm_add_pd(_mm_mul_pd(rx, ax), _mm_mul_pd(ry, ay));
+        overlap = _mm_and_pd(overlap, _mm_cmple_pd(_mm_andnot_pd(signBit, du),
+                _mm_add_pd(_mm_load_pd(block.halfWidth + lane), ru)));
+        __m128d dv = _mm_sub_pd(_mm_mul_pd(dy, ux), _mm_mul_pd(dx, uy));
+        __m128d rv = _mm_add_pd(_mm_mul_pd(rx, ay), _mm_mul_pd(ry, ax));
+        overlap = _mm_and_pd(overlap, _mm_cmple_pd(_mm_andnot_pd(signBit, dv),
+                _mm_add_pd(_mm_load_pd(block.halfLength + lane), rv)));
+        mask |= _mm_movemask_pd(overlap) << lane;
+    }
+    return mask;
+#else
+    unsigned int mask = 0;
+    for (unsigned int lane = 0; lane < BLOCK_SIZE; lane += 1) {
+        double ux = block.ux[lane];
+        double uy = block.uy[lane];
+        double dx = x - block.cx[lane];
+        double dy = y - block.cy[lane];
+        if (abs(dx) <= block.extentX[lane] + halfWidth
+                && abs(dy) <= block.extentY[lane] + halfLength
+                && abs(dx * ux + dy * uy) <= block.halfWidth[lane]
+                + halfWidth * abs(ux) + halfLength * abs(uy)
+                && abs(dy * ux - dx * uy) <= block.halfLength[lane]
+                + halfWidth * abs(uy) + halfLength * abs(ux)) {
+            mask |= 1u << lane;
+        }
+    }
+    return mask;
+#endif
+}
@@ -0,0 +1,145 @@
+#ifndef WALLGRID_H
+#define WALLGRID_H
+
+#include <vector>
+#include "ImageObject.h"
+
+namespace deflection {
+
+/**
+ * A uniform grid over the screen, mapping each cell to the walls that overlap
+ * it. It is built once per level, and lets a moving object test only the walls
+ * near it instead of every wall in the level. The walls of each cell are
+ * stored in blocks of four, as a structure of arrays, so that an axis-aligned
+ * box can be tested against a whole block at once with SIMD instructions.
+ *
+ * @author Trevor Day
+ */
+class WallGrid {
+public:
+
+    /** The number of walls in each WallBlock. */
+    static constexpr unsigned int BLOCK_SIZE = 4;
+
+    /**
+     * The geometry of up to four walls, with each value of the walls kept in
+     * its own array so that it can be loaded into one SIMD register. Unused
+     * lanes hold a wall far outside the screen, which nothing can hit.
+     */
+    struct WallBlock {
+
+        /** The x coordinates of the centers of the walls. */
+        alignas(32) double cx[BLOCK_SIZE];
+
+        /** The y coordinates of the centers of the walls. */
+        alignas(32) double cy[BLOCK_SIZE];
+
+        /** The x components of the unit vectors along the widths. */
+        alignas(32) double ux[BLOCK_SIZE];
+
+        /** The y components of the unit vectors along the widths. */
+        alignas(32) double uy[BLOCK_SIZE];
+
+        /** Half of the widths of the walls. */
+        alignas(32) double halfWidth[BLOCK_SIZE];
+
+        /** Half of the lengths of the walls. */
+        alignas(32) double halfLength[BLOCK_SIZE];
+
+        /** Half of the extents of the walls along the x axis. */
+        alignas(32) double extentX[BLOCK_SIZE];
+
+        /** Half of the extents of the walls along the y axis. */
+        alignas(32) double extentY[BLOCK_SIZE];
+
+        /** The indices of the walls in the vector the grid was built from. */
+        unsigned int wall[BLOCK_SIZE];
+    };
+
+    /**
+     * Constructs an empty WallGrid, with no cells and no walls.
+     */
+    WallGrid() noexcept;
+
+    /**
+     * Rebuilds this WallGrid for the given walls, replacing any walls it held
+     * before. Walls that extend past the screen are kept in the cells at the
+     * screen edges.
+     * @param walls is the vector of walls to put in the grid. Its indices are
+     * the ones returned by findHits, so it must not change while this grid is
+     * used.
+     * @param screenWidth is the width of the screen.
+     * @param screenHeight is the height of the screen.
+     * @param cellSize is the length of the sides of each square cell.
+     */
+    void build(const std::vector<ImageObject>& walls, unsigned int screenWidth,
+            unsigned int screenHeight, double cellSize = 32.0);
+
+    /**
+     * Finds the walls hit by the given axis-aligned box, using the separating
+     * axis theorem on the blocks of the cells the box touches.
+     * @param x is the x coordinate of the center of the box.
+     * @param y is the y coordinate of the center of the box.
+     * @param halfWidth is half of the width of the box.
+     * @param halfLength is half of the length of the box.
+     * @param walls is the vector the indices of the walls hit are written to.
+     * It is cleared first, and on return holds each index once, in increasing
+     * order.
+     */
+    void findHits(double x, double y, double halfWidth, double halfLength,
+            std::vector<unsigned int>& walls) const;
+
+    /**
+     * A static method which tests the given axis-aligned box against all the
+     * walls of the given block at once. Only four axes are needed for each
+     * pair, the x and y axes of the box and the two axes of the wall, as the
+     * other sides of both rectangles are parallel to these.
+     * @param block is the WallBlock to test against.
+     * @param x is the x coordinate of the center of the box.
+     * @param y is the y coordinate of the center of the box.
+     * @param halfWidth is half of the width of the box.
+     * @param halfLength is half of the length of the box.
+     * @return a bitmask with bit i set if the box hits the wall in lane i.
+     */
+    static unsigned int hitMask(const WallBlock& block, double x, double y,
+            double halfWidth, double halfLength) noexcept;
+
+private:
+
+    /**
+     * Returns the column of the cell containing the given x coordinate,
+     * clamped to the grid.
+     * @param x is the x coordinate.
+     * @return an unsigned int representing the column.
+     */
+    unsigned int column(double x) const noexcept;
+
+    /**
+     * Returns the row of the cell containing the given y coordinate, clamped
+     * to the grid.
+     * @param y is the y coordinate.
+     * @return an unsigned int representing the row.
+     */
+    unsigned int row(double y) const noexcept;
+
+    /** The length of the sides of each cell. */
+    double cellSize_ = 32.0;
+
+    /** The number of columns of cells. */
+    unsigned int columns_ = 0;
+
+    /** The number of rows of cells. */
+    unsigned int rows_ = 0;
+
+    /**
+     * For each cell, in row major order, the offset of its first block in
+     * blocks_, followed by one final offset marking the end of the last cell.
+     */
+    std::vector<unsigned int> cellStarts_;
+
+    /** The blocks of walls of each cell, stored one cell after another. */
+    std::vector<WallBlock> blocks_;
+};
+}
+
+#endif /* WALLGRID_H */